@@ -0,0 +1,80 @@
+/*
+ * File:    SigPack.h
+ * Purpose: layout of a signature pack, the signature files of all compilers
+ *          and the prototypes file in one file
+ */
+#pragma once
+#include <stdint.h>
+#include <string.h>
+#include <vector>
+
+/** A signature pack is made by makedsig -pack, and is read by dcc instead
+    of the single signature files when it is found in the sigs directory.
+    All numbers are little endian:
+        "dccP"                  magic
+        uint16  version         VERSION
+        uint16  numSections
+        numSections times:
+            char    name[8]     e.g. "dccb2s" for dccb2s.sig, "dcclibs" for
+                                dcclibs.dat; zero padded
+            uint32  offset      from the start of the pack, a multiple of 4
+            uint32  size
+        the sections, which hold the unchanged contents of the files
+    Sections are aligned so the tables of a mapped pack can be used in place. */
+struct SigPack
+{
+    static constexpr uint16_t VERSION = 1;
+    static constexpr int NAME_LEN = 8;
+    static constexpr int HEADER_SIZE = 8;
+    static constexpr int ENTRY_SIZE = NAME_LEN + 8;
+    static constexpr int ALIGN = 4;
+
+    struct Section
+    {
+        char            name[NAME_LEN+1];
+        const uint8_t * data;
+        uint32_t        size;
+    };
+    std::vector<Section> sections;
+
+    /** Reads the directory of the pack held in data; false if it is not a
+        pack of this version or a section lies outside of size bytes */
+    bool open(const uint8_t *data, size_t size)
+    {
+        sections.clear();
+        if ((size < HEADER_SIZE) or (memcmp(data, "dccP", 4) != 0) or (read16(data+4) != VERSION))
+            return false;
+        uint16_t numSections = read16(data+6);
+        if (size < HEADER_SIZE + (size_t)numSections * ENTRY_SIZE)
+            return false;
+        for (int i = 0; i < numSections; i++)
+        {
+            const uint8_t *entry = data + HEADER_SIZE + i * ENTRY_SIZE;
+            Section s;
+            memcpy(s.name, entry, NAME_LEN);
+            s.name[NAME_LEN] = '\0';
+            uint32_t offset = read32(entry + NAME_LEN);
+            s.size = read32(entry + NAME_LEN + 4);
+            if ((offset % ALIGN) or (offset > size) or (s.size > size - offset))
+                return false;
+            s.data = data + offset;
+            sections.push_back(s);
+        }
+        return true;
+    }
+    const Section *find(const char *name) const
+    {
+        for (const Section &s : sections)
+            if (strncmp(s.name, name, NAME_LEN) == 0)
+                return &s;
+        return nullptr;
+    }
+    static uint16_t read16(const uint8_t *p)
+    {
+        return (uint16_t)(p[1] << 8) + (uint16_t)p[0];
+    }
+    static uint32_t read32(const uint8_t *p)
+    {
+        return read16(p) + ((uint32_t)read16(p+2) << 16);
+    }
+};
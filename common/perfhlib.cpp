@@ -18,6 +18,14 @@
 #include <cassert>
 #include <stdlib.h>
 #include <string.h>
+#include <atomic>
+#include <climits>
+#include <random>
+#include <thread>
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define HASH_AVX2   /* hashMany() uses AVX2 when the CPU has it */
+#include <immintrin.h>
+#endif
 /* Private data structures */
 
 //static  int     NumEntry;   /* Number of entries in the hash table (# keys) */
@@ -27,20 +35,40 @@
 //static  int     NumVert;    /* c times NumEntry */
 
 //static  uint16_t    *T1base, *T2base;   /* Pointers to start of T1, T2 */
-static  uint16_t    *T1, *T2;   /* Pointers to T1[i], T2[i] */
-
-static  int     *graphNode; /* The array of edges */
-static  int     *graphNext; /* Linked list of edges */
-static  int     *graphFirst;/* First edge at a vertex */
 
-
-static  int     numEdges;   /* An edge counter */
-static  bool    *visited;   /* Array of bools: whether visited */
-static  bool    *deleted;   /* Array of bools: whether deleted */
+/* A candidate pair of tables T1 and T2, and the graph they make of the keys:
+    each key is an edge between its vertices f1 and f2. Each thread of map()
+    has its own. */
+struct KeyGraph
+{
+    std::vector<uint16_t> T1, T2;
+    std::vector<uint32_t> fused;    /* T1 and T2 interleaved, see fuseTables() */
+    std::vector<int>  graphNode;    /* The array of edges */
+    std::vector<int>  graphNext;    /* Linked list of edges */
+    std::vector<int>  graphFirst;   /* First edge at a vertex */
+    int               numEdges;     /* An edge counter */
+    std::vector<bool> visited;      /* Whether visited */
+    std::vector<bool> deleted;      /* Whether deleted */
+
+    KeyGraph(int numEntry, int entryLen, int setSize, int numVert) :
+        T1(entryLen * setSize), T2(entryLen * setSize), fused(entryLen * setSize),
+        graphNode(numEntry*2 + 1), graphNext(numEntry*2 + 1), graphFirst(numVert + 1),
+        numEdges(0), visited(numVert + 1), deleted(numEntry + 1)
+    {
+    }
+};
 
 /* Private prototypes */
 static void duplicateKeys(int v1, int v2);
 
+/* Returns a % d for a and d below 2^16, with recip = 0xFFFFFFFF / d + 1,
+    by multiplying rather than dividing (Lemire, Kaser and Kurz) */
+static inline uint32_t fastMod(uint32_t a, uint32_t recip, uint32_t d)
+{
+    uint32_t low = recip * a;
+    return (uint32_t)(((uint64_t)low * d) >> 32);
+}
+
 void PerfectHash::setHashParams(int _NumEntry, int _EntryLen, int _SetSize, char _SetMin,
                                 int _NumVert)
 {
@@ -48,11 +76,13 @@ void PerfectHash::setHashParams(int _NumEntry, int _EntryLen, int _SetSize, char
         passing all these (or defererencing pointers) for every call to hash()
     */
 
+    hashCleanup();                          /* Tables of an earlier call */
     NumEntry = _NumEntry;
     EntryLen = _EntryLen;
     SetSize  = _SetSize;
     SetMin   = _SetMin;
     NumVert  = _NumVert;
+    setReciprocals();
 
     /* Allocate the variable sized tables etc */
     if ((T1base = (uint16_t *)malloc(EntryLen * SetSize * sizeof(uint16_t))) == nullptr)
@@ -64,31 +94,13 @@ void PerfectHash::setHashParams(int _NumEntry, int _EntryLen, int _SetSize, char
         goto BadAlloc;
     }
 
-    if ((graphNode = (int *)malloc((NumEntry*2 + 1) * sizeof(int))) == nullptr)
-    {
-        goto BadAlloc;
-    }
-    if ((graphNext = (int *)malloc((NumEntry*2 + 1) * sizeof(int))) == nullptr)
-    {
-        goto BadAlloc;
-    }
-    if ((graphFirst = (int *)malloc((NumVert + 1) * sizeof(int))) == nullptr)
-    {
-        goto BadAlloc;
-    }
-
     if ((g = (short *)malloc((NumVert+1) * sizeof(short))) == nullptr)
     {
         goto BadAlloc;
     }
-    if ((visited = (bool *)malloc((NumVert+1) * sizeof(bool))) == nullptr)
-    {
-        goto BadAlloc;
-    }
-    if ((deleted = (bool *)malloc((NumEntry+1) * sizeof(bool))) == nullptr)
-    {
-        goto BadAlloc;
-    }
+    m_T1 = T1base;                          /* The tables are filled in later */
+    m_T2 = T2base;
+    m_g  = g;
     return;
 
 BadAlloc:
@@ -97,101 +109,156 @@ BadAlloc:
     exit(1);
 }
 
+void PerfectHash::setHashTables(int _NumEntry, int _EntryLen, int _SetSize, char _SetMin,
+                                int _NumVert, const uint16_t *t1, const uint16_t *t2,
+                                const uint16_t *_g)
+{
+    hashCleanup();
+    NumEntry = _NumEntry;
+    EntryLen = _EntryLen;
+    SetSize  = _SetSize;
+    SetMin   = _SetMin;
+    NumVert  = _NumVert;
+
+    m_T1 = t1;
+    m_T2 = t2;
+    m_g  = (const short *)_g;
+    setReciprocals();
+    fuseTables();
+}
+
+void PerfectHash::setReciprocals()
+{
+    m_vertRecip  = 0xFFFFFFFFu / (uint32_t)NumVert + 1;
+    m_entryRecip = 0xFFFFFFFFu / (uint32_t)NumEntry + 1;
+}
+
+void PerfectHash::fuseTables()
+{
+    m_fused.resize(EntryLen * SetSize);
+    for (size_t i=0; i < m_fused.size(); i++)
+    {
+        m_fused[i] = m_T1[i] | ((uint32_t)m_T2[i] << 16);
+    }
+}
+
 void PerfectHash::hashCleanup()
 {
     /* Free the storage for variable sized tables etc */
-    if (T1base) free(T1base);
-    if (T2base) free(T2base);
-    if (graphNode) free(graphNode);
-    if (graphNext) free(graphNext);
-    if (graphFirst) free(graphFirst);
-    if (g) free(g);
-    if (visited) free(visited);
-    if (deleted) free(deleted);
+    free(T1base);
+    free(T2base);
+    free(g);
+    T1base = T2base = nullptr;
+    g = nullptr;
+    m_T1 = m_T2 = nullptr;
+    m_g = nullptr;
+    m_fused.clear();
+    delete m_graph;
+    m_graph = nullptr;
 }
 
-void PerfectHash::map(PatternCollector *collector)
+void PerfectHash::map(PatternCollector *collector, uint32_t seed, int jobs)
 {
     m_collector = collector;
     assert(nullptr!=collector);
-    int i, j, c;
-    uint16_t f1, f2;
-    bool cycle;
-    uint8_t *keys;
+    assert(T1base and T2base and g);        /* Needs the tables of setHashParams() */
+    std::atomic<int> next(0);               /* Next candidate to try */
+    std::atomic<int> found(INT_MAX);        /* Lowest candidate that worked */
 
-    c = 0;
-
-    do
+    /* Candidates are taken in order, so all the ones below found are tried */
+    auto worker = [this,seed,&next,&found]()
     {
-        initGraph();
-        cycle = false;
-
-        /* Randomly generate T1 and T2 */
-        for (i=0; i < SetSize*EntryLen; i++)
+        KeyGraph graph(NumEntry, EntryLen, SetSize, NumVert);
+        for (int c = next++; c < found; c = next++)
         {
-            T1base[i] = rand() % NumVert;
-            T2base[i] = rand() % NumVert;
+            if (not tryTables(seed, c, graph, false))
+                continue;
+            int best = found;
+            while ((c < best) and not found.compare_exchange_weak(best, c))
+                ;
         }
+    };
+    std::vector<std::thread> threads;
+    for (int i=1; i < jobs; i++)
+    {
+        threads.emplace_back(worker);
+    }
+    worker();
+    for (std::thread &t : threads)
+    {
+        t.join();
+    }
 
-        for (i=0; i < NumEntry; i++)
+    /* Make the winner again, for its tables, the graph assign() needs, and
+        the messages about its duplicate keys */
+    delete m_graph;
+    m_graph = new KeyGraph(NumEntry, EntryLen, SetSize, NumVert);
+    tryTables(seed, found, *m_graph, true);
+    memcpy(T1base, m_graph->T1.data(), m_graph->T1.size() * sizeof(uint16_t));
+    memcpy(T2base, m_graph->T2.data(), m_graph->T2.size() * sizeof(uint16_t));
+    fuseTables();
+    m_iterations = found + 1;
+}
+
+/* Randomly generates T1 and T2 of the given candidate into graph, with a
+    random stream of its own, and adds the keys to the graph. Returns true if
+    the graph has no cycles, i.e. the tables can be used. */
+bool PerfectHash::tryTables(uint32_t seed, int candidate, KeyGraph &graph, bool verbose) const
+{
+    std::seed_seq seq {seed, (uint32_t)candidate};
+    std::mt19937 rng(seq);
+    int i;
+    uint16_t f1, f2;
+
+    for (i=0; i < SetSize*EntryLen; i++)
+    {
+        graph.T1[i] = rng() % NumVert;
+        graph.T2[i] = rng() % NumVert;
+        graph.fused[i] = graph.T1[i] | ((uint32_t)graph.T2[i] << 16);
+    }
+    initGraph(graph);
+    for (i=0; i < NumEntry; i++)
+    {
+        vertices(graph.fused.data(), m_collector->getKey(i), f1, f2);
+        if (f1 == f2)
         {
-            f1 = 0; f2 = 0;
-            keys = m_collector->getKey(i);
-            for (j=0; j < EntryLen; j++)
-            {
-                T1 = T1base + j * SetSize;
-                T2 = T2base + j * SetSize;
-                f1 += T1[keys[j] - SetMin];
-                f2 += T2[keys[j] - SetMin];
-            }
-            f1 %= (uint16_t)NumVert;
-            f2 %= (uint16_t)NumVert;
-            if (f1 == f2)
-            {
-                /* A self loop. Reject! */
+            /* A self loop. Reject! */
+            if (verbose)
                 printf("Self loop on vertex %d!\n", f1);
-                cycle = true;
-                break;
-            }
-            addToGraph(numEdges++, f1, f2);
-        }
-        if (cycle or (cycle = isCycle()))   /* OK - is there a cycle? */
-        {
-            printf("Iteration %d\n", ++c);
-        }
-        else
-        {
-            break;
+            return false;
         }
+        addToGraph(graph, graph.numEdges++, f1, f2);
     }
-    while (/* there is a cycle */ true);
-
+    return not isCycle(graph, verbose);
 }
 
 /* Initialise the graph */
-void PerfectHash::initGraph()
+void PerfectHash::initGraph(KeyGraph &graph) const
 {
     int i;
 
     for (i=1; i <= NumVert; i++)
     {
-        graphFirst[i] = 0;
+        graph.graphFirst[i] = 0;
     }
 
     for (i= -NumEntry; i <= NumEntry; i++)
     {
         /* No need to init graphNode[] as they will all be filled by successive
             calls to addToGraph() */
-        graphNext[NumEntry+i] = 0;
+        graph.graphNext[NumEntry+i] = 0;
     }
 
-    numEdges = 0;
+    graph.numEdges = 0;
 }
 
 /* Add an edge e between vertices v1 and v2 */
 /* e, v1, v2 are 0 based */
-void PerfectHash::addToGraph(int e, int v1, int v2)
+void PerfectHash::addToGraph(KeyGraph &graph, int e, int v1, int v2) const
 {
+    std::vector<int> &graphNode(graph.graphNode);
+    std::vector<int> &graphNext(graph.graphNext);
+    std::vector<int> &graphFirst(graph.graphFirst);
     e++; v1++; v2++;                        /* So much more convenient */
 
     graphNode[NumEntry+e] = v2;             /* Insert the edge information */
@@ -204,8 +271,14 @@ void PerfectHash::addToGraph(int e, int v1, int v2)
 
 }
 
-bool PerfectHash::DFS(int parentE, int v)
+/* Messages are only printed if verbose is set */
+bool PerfectHash::DFS(KeyGraph &graph, int parentE, int v, bool verbose) const
 {
+    std::vector<int> &graphNode(graph.graphNode);
+    std::vector<int> &graphNext(graph.graphNext);
+    std::vector<int> &graphFirst(graph.graphFirst);
+    std::vector<bool> &visited(graph.visited);
+    std::vector<bool> &deleted(graph.deleted);
     int e, w;
 
     /* Depth first search of the graph, starting at vertex v, looking for
@@ -260,18 +333,22 @@ bool PerfectHash::DFS(int parentE, int v)
                     key2=m_collector->getKey(abs(parentE)-1);
                     if (memcmp(key1, key2, EntryLen) == 0)
                     {
-                        printf("Duplicate keys with edges %d and %d (",
-                               e, parentE);
-                        m_collector->dispKey(abs(e)-1);
-                        printf(" & ");
-                        m_collector->dispKey(abs(parentE)-1);
-                        printf(")\n");
+                        if (verbose)
+                        {
+                            printf("Duplicate keys with edges %d and %d (",
+                                   e, parentE);
+                            m_collector->dispKey(abs(e)-1);
+                            printf(" & ");
+                            m_collector->dispKey(abs(parentE)-1);
+                            printf(")\n");
+                        }
                         deleted[abs(e)] = true;      /* Wipe the key */
                     }
                     else
                     {
                         /* A genuine (unit) cycle. */
-                        printf("There is a unit cycle involving vertex %d and edge %d\n", v, e);
+                        if (verbose)
+                            printf("There is a unit cycle involving vertex %d and edge %d\n", v, e);
                         return true;
                     }
 
@@ -280,7 +357,8 @@ bool PerfectHash::DFS(int parentE, int v)
                 {
                     /* We have reached a previously visited vertex not the
                         parent. Therefore, we have uncovered a genuine cycle */
-                    printf("There is a cycle involving vertex %d and edge %d\n", v, e);
+                    if (verbose)
+                        printf("There is a cycle involving vertex %d and edge %d\n", v, e);
                     return true;
 
                 }
@@ -288,7 +366,7 @@ bool PerfectHash::DFS(int parentE, int v)
         }
         else                                /* Not yet seen. Traverse it */
         {
-            if (DFS(e, w))
+            if (DFS(graph, e, w, verbose))
             {
                 /* Cycle found deeper down. Exit */
                 return true;
@@ -298,8 +376,10 @@ bool PerfectHash::DFS(int parentE, int v)
     return false;
 }
 
-bool PerfectHash::isCycle()
+bool PerfectHash::isCycle(KeyGraph &graph, bool verbose) const
 {
+    std::vector<bool> &visited(graph.visited);
+    std::vector<bool> &deleted(graph.deleted);
     int v, e;
 
     for (v=1; v <= NumVert; v++)
@@ -314,7 +394,7 @@ bool PerfectHash::isCycle()
     {
         if (not visited[v])
         {
-            if (DFS(-32767, v))
+            if (DFS(graph, -32767, v, verbose))
             {
                 return true;
             }
@@ -325,6 +405,10 @@ bool PerfectHash::isCycle()
 
 void PerfectHash::traverse(int u)
 {
+    std::vector<int> &graphNode(m_graph->graphNode);
+    std::vector<int> &graphNext(m_graph->graphNext);
+    std::vector<int> &graphFirst(m_graph->graphFirst);
+    std::vector<bool> &visited(m_graph->visited);
     int w, e;
 
     visited[u] = true;
@@ -346,6 +430,7 @@ void PerfectHash::traverse(int u)
 
 void PerfectHash::assign()
 {
+    std::vector<bool> &visited(m_graph->visited);
     int v;
 
 
@@ -365,28 +450,103 @@ void PerfectHash::assign()
     }
 }
 
-int PerfectHash::hash(uint8_t *string)
+/* Finds the vertices f1 and f2 of the edge of key in the graph, by summing
+    the T1 and T2 entries of its bytes in one pass; T12 is the fused table,
+    or nullptr to read T1 and T2 */
+void PerfectHash::vertices(const uint32_t *T12, const uint8_t *key, uint16_t &f1, uint16_t &f2) const
 {
-    uint16_t u, v;
+    uint32_t u, v;                          /* Only the low 16 bits count */
     int  j;
 
-    u = 0;
-    for (j=0; j < EntryLen; j++)
+    u = 0; v = 0;
+    if (T12)
+    {
+        for (j=0; j < EntryLen; j++, T12 += SetSize)
+        {
+            uint32_t e = T12[key[j] - SetMin];
+            u += e & 0xFFFF;
+            v += e >> 16;
+        }
+    }
+    else
     {
-        T1 = T1base + j * SetSize;
-        u += T1[string[j] - SetMin];
+        for (j=0; j < EntryLen; j++)
+        {
+            int c = j * SetSize + key[j] - SetMin;
+            u += m_T1[c];
+            v += m_T2[c];
+        }
     }
-    u %= NumVert;
+    f1 = fastMod(u & 0xFFFF, m_vertRecip, NumVert);
+    f2 = fastMod(v & 0xFFFF, m_vertRecip, NumVert);
+}
 
-    v = 0;
-    for (j=0; j < EntryLen; j++)
+/* The index in the hash table of the key with vertices u and v */
+int PerfectHash::entry(uint16_t u, uint16_t v) const
+{
+    int sum = m_g[u] + m_g[v];
+    if ((sum >= 0) and (sum <= 0xFFFF))     /* Always, for tables made by map() and assign() */
+        return fastMod(sum, m_entryRecip, NumEntry);
+    return sum % NumEntry;
+}
+
+int PerfectHash::hash(const uint8_t *string) const
+{
+    uint16_t u, v;
+
+    vertices(m_fused.empty() ? nullptr : m_fused.data(), string, u, v);
+    return entry(u, v);
+}
+
+#ifdef HASH_AVX2
+/* Sums the fused table entries of the 8 keys at key, stored entryLen bytes
+    apart, into u and v; the entries of each key position are gathered at once */
+__attribute__((target("avx2")))
+static void sumGroupAvx2(const uint32_t *fused, const uint8_t *key, int entryLen, int setSize,
+                         int setMin, uint32_t u[8], uint32_t v[8])
+{
+    __m256i su = _mm256_setzero_si256();
+    __m256i sv = _mm256_setzero_si256();
+    const __m256i lo = _mm256_set1_epi32(0xFFFF);
+    const __m256i min = _mm256_set1_epi32(setMin);
+    for (int j=0; j < entryLen; j++, fused += setSize)
     {
-        T2 = T2base + j * SetSize;
-        v += T2[string[j] - SetMin];
+        __m256i c = _mm256_setr_epi32(key[j], key[entryLen+j], key[2*entryLen+j],
+                key[3*entryLen+j], key[4*entryLen+j], key[5*entryLen+j],
+                key[6*entryLen+j], key[7*entryLen+j]);
+        __m256i e = _mm256_i32gather_epi32((const int *)fused, _mm256_sub_epi32(c, min), 4);
+        su = _mm256_add_epi32(su, _mm256_and_si256(e, lo));
+        sv = _mm256_add_epi32(sv, _mm256_srli_epi32(e, 16));
     }
-    v %= NumVert;
+    _mm256_storeu_si256((__m256i *)u, su);
+    _mm256_storeu_si256((__m256i *)v, sv);
+}
+#endif
+
+void PerfectHash::hashMany(const uint8_t *keys, int count, int *out) const
+{
+    int i = 0;
 
-    return (g[u] + g[v]) % NumEntry;
+#ifdef HASH_AVX2
+    static const bool hasAvx2 = __builtin_cpu_supports("avx2");
+    if (hasAvx2 and not m_fused.empty())
+    {
+        uint32_t u[8], v[8];
+        for (; i + 8 <= count; i += 8)
+        {
+            sumGroupAvx2(m_fused.data(), keys + i * EntryLen, EntryLen, SetSize, SetMin, u, v);
+            for (int k=0; k < 8; k++)
+            {
+                out[i+k] = entry(fastMod(u[k] & 0xFFFF, m_vertRecip, NumVert),
+                                 fastMod(v[k] & 0xFFFF, m_vertRecip, NumVert));
+            }
+        }
+    }
+#endif
+    for (; i < count; i++)
+    {
+        out[i] = hash(keys + i * EntryLen);
+    }
 }
 
 #if 0
@@ -1,38 +1,77 @@
 #pragma once
 #include <stdint.h>
+#include <vector>
 /** Perfect hashing function library. Contains functions to generate perfect
     hashing functions */
 struct PatternCollector;
+struct KeyGraph;
 struct PerfectHash {
-    uint16_t    *T1base;
-    uint16_t    *T2base;   /* Pointers to start of T1, T2 */
-    short   *g;         /* g[] */
+    uint16_t    *T1base=nullptr;
+    uint16_t    *T2base=nullptr;   /* T1, T2 allocated by setHashParams(), else null */
+    short   *g=nullptr;         /* g[] allocated by setHashParams(), else null */
 
     int     NumEntry;   /* Number of entries in the hash table (# keys) */
     int     EntryLen;   /* Size (bytes) of each entry (size of keys) */
     int     SetSize;    /* Size of the char set */
     char    SetMin;     /* First char in the set */
     int     NumVert;    /* c times NumEntry */
-    /** Set the parameters for the hash table */
+    /** Set the parameters for the hash table, and allocate T1, T2 and g */
     void setHashParams(int _numEntry, int _entryLen, int _setSize, char _setMin, int _numVert);
+    /** Set the parameters for the hash table, and use T1, T2 and g where
+        they are (e.g. in a mapped signature file) instead of allocating them.
+        The tables are only read, and not freed by hashCleanup() */
+    void setHashTables(int _numEntry, int _entryLen, int _setSize, char _setMin, int _numVert,
+                       const uint16_t *t1, const uint16_t *t2, const uint16_t *_g);
 
 public:
-    void map(PatternCollector * collector); /* Part 1 of creating the tables */
-    void hashCleanup(); /* Frees memory allocated by setHashParams() */
+    /** Part 1 of creating the tables: tries random T1 and T2 until the keys
+        make a graph without cycles. Candidate tables are numbered, and each
+        is drawn from a random stream of its own, seeded with seed and its
+        number; jobs threads try them at once. The lowest numbered candidate
+        that works is taken, so the tables only depend on seed. */
+    void map(PatternCollector * collector, uint32_t seed=1, int jobs=1);
+    /** Number of candidate tables up to the one map() took */
+    int iterations() const { return m_iterations; }
+    void hashCleanup(); /* Frees memory allocated by setHashParams(), and forgets the tables */
     void assign(); /* Part 2 of creating the tables */
-    int hash(uint8_t *string); /* Hash the string to an int 0 .. NUMENTRY-1 */
-    const uint16_t *readT1(void) const { return T1base; }
-    const uint16_t *readT2(void) const { return T2base; }
-    const uint16_t *readG(void) const  { return (uint16_t *)g; }
+    int hash(const uint8_t *string) const; /* Hash the string to an int 0 .. NUMENTRY-1 */
+    /** Hash count keys, stored EntryLen bytes apart, into out[0..count-1].
+        Same results as hash(); on x86 CPUs with AVX2, eight keys at a time,
+        gathering the table entries of a key position at once */
+    void hashMany(const uint8_t *keys, int count, int *out) const;
+    /** Builds the interleaved copy of T1 and T2 that hash() and hashMany()
+        read, so that one load gives both entries of a key byte. Needed again
+        whenever T1 or T2 change; without it they read T1 and T2 directly */
+    void fuseTables();
+    /** The tables hash() reads */
+    const uint16_t *readT1(void) const { return m_T1; }
+    const uint16_t *readT2(void) const { return m_T2; }
+    const uint16_t *readG(void) const  { return (const uint16_t *)m_g; }
+    /** The tables allocated by setHashParams(), to fill in; null for the
+        tables given to setHashTables() */
     uint16_t *readT1(void){ return T1base; }
     uint16_t *readT2(void){ return T2base; }
     uint16_t *readG(void) { return (uint16_t *)g; }
 private:
-    void initGraph();
-    void addToGraph(int e, int v1, int v2);
-    bool isCycle();
-    bool DFS(int parentE, int v);
+    bool tryTables(uint32_t seed, int candidate, KeyGraph &graph, bool verbose) const;
+    void initGraph(KeyGraph &graph) const;
+    void addToGraph(KeyGraph &graph, int e, int v1, int v2) const;
+    bool isCycle(KeyGraph &graph, bool verbose) const;
+    bool DFS(KeyGraph &graph, int parentE, int v, bool verbose) const;
     void traverse(int u);
+    void vertices(const uint32_t *T12, const uint8_t *key, uint16_t &f1, uint16_t &f2) const;
+    int entry(uint16_t u, uint16_t v) const;
+    void setReciprocals();
     PatternCollector *m_collector; /* used to retrieve the keys */
+    KeyGraph *m_graph = nullptr;   /* graph of the tables map() took, for assign() */
+    int m_iterations = 0;
+    /* T1, T2 and g as hash() reads them: T1base, T2base and g, or the tables
+        given to setHashTables() */
+    const uint16_t *m_T1 = nullptr;
+    const uint16_t *m_T2 = nullptr;
+    const short *m_g = nullptr;
+    std::vector<uint32_t> m_fused; /* T1[j][c] | T2[j][c] << 16 for byte c at position j */
+    uint32_t m_vertRecip;   /* For % NumVert and % NumEntry by multiplication */
+    uint32_t m_entryRecip;
 
 };
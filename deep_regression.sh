@@ -0,0 +1,39 @@
+#!/bin/bash
+# Parses two COM programs nested deeper than a recursive FollowCtrl could
+# follow on the stack: a chain of CALLS calls, each into a procedure of its
+# own, and JUMPS conditional jumps in a row. The -j 1 parse (FollowCtrl's
+# worklist) must list every procedure and icode, and -j JOBS (ConcurrentParser)
+# must list them the same.
+# Usage: deep_regression.sh DCC [JOBS], run from the dcc directory.
+DCC=$(realpath "$1")
+JOBS=${2:-4}
+CALLS=12000
+JUMPS=20000
+OUT=$(mktemp -d)
+trap 'rm -rf "$OUT"' EXIT
+
+# start: CALL link1; MOV AX,4C00h; INT 21h. Each link: CALL next; RET
+{ printf '\xe8\x05\x00\xb8\x00\x4c\xcd\x21'; printf '\xe8\x01\x00\xc3%.0s' $(seq $CALLS); printf '\xc3'; } > $OUT/DEEPCALL.COM
+# JE $+2, JUMPS times, then MOV AH,4Ch; INT 21h
+{ printf '\x74\x00%.0s' $(seq $JUMPS); printf '\xb4\x4c\xcd\x21'; } > $OUT/DEEPJCC.COM
+
+status=0
+check() {
+	local name=$1 procs=$2 icodes=$3
+	for j in 1 $JOBS; do
+		if ! $DCC -j $j -a 1 -o$OUT/$name.j$j.a1 $OUT/$name.COM >/dev/null 2>&1; then
+			echo "$name: dcc -j $j failed"
+			status=1
+			return
+		fi
+	done
+	local a1=$OUT/$name.j1.a1
+	if [ $(grep -c ENDP $a1) != $procs ] || [ $(grep -cE '^[0-9]+ [0-9A-F]{6} ' $a1) != $icodes ]; then
+		echo "$name: expected $procs procedures and $icodes icodes"
+		status=1
+	fi
+	cmp $a1 $OUT/$name.j$JOBS.a1 || status=1
+}
+check DEEPCALL $((CALLS + 2)) $((2 * CALLS + 4))
+check DEEPJCC 1 $((JUMPS + 2))
+exit $status
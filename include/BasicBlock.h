@@ -2,6 +2,7 @@
 #include "icode.h"
 #include "types.h"
 #include "graph.h"
+#include "ObjectArena.h"
 
 #include <boost/range/iterator_range.hpp>
 #include <list>
@@ -32,6 +33,7 @@ struct TYPEADR_TYPE
 struct BB
 {
     friend struct Function;
+    friend class ObjectArena<BB>;
 private:
     BB(const BB&);
     BB() : nodeType(0),traversed(DFS_NONE),
@@ -105,6 +107,9 @@ public:
     static BB * Create(void *ctx=0,const std::string &s="",Function *parent=0,BB *insertBefore=0);
     static BB * CreateIntervalBB(Function *parent);
     static BB * Create(const rCODE &r, eBBKind _nodeType, Function *parent);
+private:
+    BB *    init(const rCODE &r, eBBKind _nodeType, Function *parent);
+public:
     void    writeCode(int indLevel, Function *pProc, int *numLoc, int latchNode, int ifFollow);
     void    mergeFallThrough(CIcodeRec &Icode);
     void    dfsNumbering(std::vector<BB *> &dfsLast, int *first, int *last);
@@ -1,9 +1,16 @@
 #pragma once
+#include "MemoryMap.h"
+
 #include <stdint.h>
+#include <memory>
 #include <vector>
+#include <utility>
+#include <algorithm>
 
+class QFile;
 struct PROG /* Loaded program image parameters  */
 {
+    static constexpr uint32_t PSP_SIZE = 0x100;  /* Image offset of the load module */
     int16_t     initCS=0;
     int16_t     initIP=0;     /* These are initial load values    */
     int16_t     initSS=0;     /* Probably not of great interest   */
@@ -11,16 +18,91 @@ struct PROG /* Loaded program image parameters  */
     bool        fCOM=false;       /* Flag set if COM program (else EXE)*/
     int         cReloc=0;     /* No. of relocation table entries  */
     std::vector<uint32_t> relocTable; /* Ptr. to relocation table         */
-    uint8_t *   map=nullptr;        /* Memory bitmap ptr                */
+    std::vector<uint32_t> relocIndex; /* Sorted copy of relocTable        */
+    std::vector<uint8_t>  relocBits;  /* Bit per image byte covered by a fixup */
+    std::vector<std::pair<uint32_t,uint8_t>> relocBytes; /* Those bytes, with the fixups applied */
+    uint16_t    relocBase=0;  /* Added to each relocated segment value */
+    MemoryMap   map;          /* Memory map of the image          */
     int         cProcs=0;     /* Number of procedures so far      */
     int         offMain=0;    /* The offset  of the main() proc   */
     uint16_t    segMain=0;    /* The segment of the main() proc   */
     bool        bSigs=false;      /* True if signatures loaded        */
     int         cbImage=0;    /* Length of image in bytes         */
-    uint8_t *   Imagez=nullptr;      /* Allocated by loader to hold entire program image */
+    const uint8_t * module=nullptr;   /* Load module, mapped from the program file */
+    std::shared_ptr<QFile> file;      /* Keeps the mapping of module alive */
+    std::vector<uint8_t> moduleCopy;  /* Holds module if the file could not be mapped */
     int         addressingMode=0;
 public:
-    const uint8_t *image() const {return Imagez;}
+    /* Returns the byte at image offset off as the loaded program sees it:
+     * offsets below PSP_SIZE read the PSP, which only has the int 20h at its
+     * start, and relocated segment values read with their fixup applied.
+     * Offsets past the end of the image read as 0. */
+    uint8_t byte(uint32_t off) const
+    {
+        if (off >= (uint32_t)cbImage)
+            return 0;
+        if (off < PSP_SIZE)
+            return (off==0) ? 0xCD : ((off==1) ? 0x20 : 0);
+        if (relocBits[off >> 3] & (1 << (off & 7)))
+            return relocatedByte(off);
+        return module[off-PSP_SIZE];
+    }
+    uint16_t word(uint32_t off) const
+    {
+        return byte(off) + (byte(off+1) << 8);
+    }
+    /* Copies n bytes starting at image offset off to dst */
+    void read(uint32_t off, uint8_t *dst, size_t n) const
+    {
+        for (size_t i = 0; i < n; ++i)
+            dst[i] = byte(off+i);
+    }
+    /* Builds the lookup index used by isRelocated and byte(), called once
+     * the loader has filled relocTable, set cbImage and mapped module.
+     * The fixups are applied to a copy of the bytes they cover one after the
+     * other, in the order of the table, as the loader used to patch its copy
+     * of the image: fixups of overlapping words both count, carries included */
+    void indexRelocations()
+    {
+        relocIndex = relocTable;
+        std::sort(relocIndex.begin(),relocIndex.end());
+        relocBytes.clear();
+        for (uint32_t off : relocIndex)
+        {
+            if (off < PSP_SIZE or off+1 >= (uint32_t)cbImage)
+                continue;
+            for (uint32_t i = off; i < off+2; ++i)
+            {
+                if (relocBytes.empty() or relocBytes.back().first < i)
+                    relocBytes.emplace_back(i,module[i-PSP_SIZE]);
+            }
+        }
+        auto patched = [this](uint32_t off) -> uint8_t & {
+            return std::lower_bound(relocBytes.begin(),relocBytes.end(),std::make_pair(off,uint8_t(0)))->second;
+        };
+        for (uint32_t off : relocTable)
+        {
+            if (off < PSP_SIZE or off+1 >= (uint32_t)cbImage)
+                continue;
+            uint8_t &lo(patched(off)), &hi(patched(off+1));
+            uint16_t w = lo + (hi << 8) + relocBase;
+            lo = (uint8_t)(w & 0xFF);
+            hi = (uint8_t)(w >> 8);
+        }
+        relocBits.assign((cbImage >> 3) + 1,0);
+        for (const std::pair<uint32_t,uint8_t> &b : relocBytes)
+            relocBits[b.first >> 3] |= 1 << (b.first & 7);
+    }
+    /* Returns true if the word at image offset off is a relocated segment value */
+    bool isRelocated(uint32_t off) const
+    {
+        return std::binary_search(relocIndex.begin(),relocIndex.end(),off);
+    }
     void displayLoadInfo();
+private:
+    /* The byte at image offset off, which relocBytes has to hold */
+    uint8_t relocatedByte(uint32_t off) const
+    {
+        return std::lower_bound(relocBytes.begin(),relocBytes.end(),std::make_pair(off,uint8_t(0)))->second;
+    }
 };
-
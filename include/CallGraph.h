@@ -1,19 +1,39 @@
 #pragma once
 #include "Procedure.h"
-/* CALL GRAPH NODE */
+
+#include <stdint.h>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+/* CALL GRAPH - one node per procedure, edges kept as adjacency lists */
 struct CALL_GRAPH
 {
-        ilFunction proc;               /* Pointer to procedure in pProcList	*/
-        std::vector<CALL_GRAPH *> outEdges; /* array of out edges                   */
-public:
-        void write();
-        CALL_GRAPH()
+        struct Node
         {
-        }
+            ilFunction          proc;       /* Pointer to procedure in pProcList    */
+            std::vector<int>    outEdges;   /* callees, in order of discovery       */
+            std::vector<int>    inEdges;    /* callers, in order of discovery       */
+        };
+        typedef std::vector<int> Component; /* node indexes of one SCC */
 public:
-        void writeNodeCallGraph(int indIdx);
+        CALL_GRAPH(ilFunction root);
+        void write();
         bool insertCallGraph(ilFunction caller, ilFunction callee);
         bool insertCallGraph(Function *caller, ilFunction callee);
-        void insertArc(ilFunction newProc);
+        /// Index of the node for given procedure, -1 if it is not in the graph
+        int findNode(const Function *proc) const;
+        int root() const { return 0; }
+        size_t size() const { return m_nodes.size(); }
+        const Node &node(int idx) const { return m_nodes[idx]; }
+        /// Strongly connected components, ordered so that every component comes
+        /// after all the components it calls into (bottom-up processing order).
+        std::vector<Component> stronglyConnectedComponents() const;
+private:
+        int  insertNode(ilFunction proc);
+        void writeNodeCallGraph(int idx, int indIdx, std::vector<bool> &expanded) const;
+
+        std::vector<Node>                       m_nodes;
+        std::unordered_map<const Function *,int> m_nodeIndex;  /* Function * -> node index  */
+        std::unordered_set<uint64_t>            m_edges;      /* (caller<<32)|callee       */
 };
 //extern CALL_GRAPH * callGraph;	/* Pointer to the head of the call graph     */
@@ -0,0 +1,201 @@
+/*
+ * File:    ChunkedVector.h
+ * Purpose: append-only random access container with stable element addresses
+ */
+#pragma once
+#include <cassert>
+#include <cstddef>
+#include <iterator>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+template<class T>
+class ChunkedVector;
+
+/** Index based iterator into a ChunkedVector.
+ * It behaves like a std::list iterator with respect to growth of the container:
+ * an iterator to an element stays valid while new elements are appended, and
+ * end() stays end() - it does not turn into an iterator to the next appended
+ * element. */
+template<class T, bool IS_CONST>
+class ChunkedVectorIterator
+{
+    friend class ChunkedVectorIterator<T,not IS_CONST>;
+    using owner_type = typename std::conditional<IS_CONST,const ChunkedVector<T>,ChunkedVector<T>>::type;
+    static constexpr size_t npos = ~size_t(0);
+
+    owner_type *m_owner=nullptr;
+    size_t      m_idx=npos;     /* npos marks end() */
+
+    size_t position() const { return (m_idx==npos) ? m_owner->size() : m_idx; }
+    void setPosition(size_t pos) { m_idx = (pos<m_owner->size()) ? pos : npos; }
+public:
+    using iterator_category = std::random_access_iterator_tag;
+    using value_type        = typename std::remove_const<T>::type;
+    using difference_type   = std::ptrdiff_t;
+    using pointer           = typename std::conditional<IS_CONST,const T *,T *>::type;
+    using reference         = typename std::conditional<IS_CONST,const T &,T &>::type;
+
+    ChunkedVectorIterator() {}
+    ChunkedVectorIterator(owner_type *owner,size_t idx) : m_owner(owner)
+    {
+        setPosition(idx);
+    }
+    template<bool OTHER_CONST,class = typename std::enable_if<IS_CONST and not OTHER_CONST>::type>
+    ChunkedVectorIterator(const ChunkedVectorIterator<T,OTHER_CONST> &other) : m_owner(other.m_owner),m_idx(other.m_idx)
+    {
+    }
+    /// Index of the element in the owning container
+    size_t      index() const { return position(); }
+
+    reference   operator*() const { assert(m_idx!=npos); return (*m_owner)[m_idx]; }
+    pointer     operator->() const { return &(**this); }
+    reference   operator[](difference_type n) const { return *(*this+n); }
+
+    ChunkedVectorIterator &operator++()
+    {
+        assert(m_idx!=npos);
+        setPosition(m_idx+1);
+        return *this;
+    }
+    ChunkedVectorIterator &operator--()
+    {
+        size_t pos = position();
+        assert(pos>0);
+        m_idx = pos-1;
+        return *this;
+    }
+    ChunkedVectorIterator operator++(int) { ChunkedVectorIterator res(*this); ++(*this); return res; }
+    ChunkedVectorIterator operator--(int) { ChunkedVectorIterator res(*this); --(*this); return res; }
+    ChunkedVectorIterator &operator+=(difference_type n)
+    {
+        setPosition(size_t(difference_type(position())+n));
+        return *this;
+    }
+    ChunkedVectorIterator &operator-=(difference_type n) { return *this += -n; }
+    ChunkedVectorIterator operator+(difference_type n) const { ChunkedVectorIterator res(*this); return res += n; }
+    ChunkedVectorIterator operator-(difference_type n) const { ChunkedVectorIterator res(*this); return res -= n; }
+    friend ChunkedVectorIterator operator+(difference_type n,const ChunkedVectorIterator &it) { return it+n; }
+    difference_type operator-(const ChunkedVectorIterator &other) const
+    {
+        assert(m_owner==other.m_owner);
+        return difference_type(position())-difference_type(other.position());
+    }
+
+    bool operator==(const ChunkedVectorIterator &other) const { return m_owner==other.m_owner and m_idx==other.m_idx; }
+    bool operator!=(const ChunkedVectorIterator &other) const { return not (*this==other); }
+    bool operator<(const ChunkedVectorIterator &other) const { return position()<other.position(); }
+    bool operator>(const ChunkedVectorIterator &other) const { return other<*this; }
+    bool operator<=(const ChunkedVectorIterator &other) const { return not (other<*this); }
+    bool operator>=(const ChunkedVectorIterator &other) const { return not (*this<other); }
+};
+
+/** Append-only sequence stored in fixed size chunks.
+ * Elements are never moved once inserted, so pointers, references and
+ * iterators survive push_back, while indexing stays O(1). */
+template<class T>
+class ChunkedVector
+{
+    static constexpr size_t CHUNK_BITS = 8;
+    static constexpr size_t CHUNK_SIZE = size_t(1)<<CHUNK_BITS;
+    std::vector<T *>    m_chunks;   /* raw storage for CHUNK_SIZE elements each */
+    size_t              m_size=0;
+public:
+    using value_type = T;
+    using size_type = size_t;
+    using reference = T &;
+    using const_reference = const T &;
+    using iterator = ChunkedVectorIterator<T,false>;
+    using const_iterator = ChunkedVectorIterator<T,true>;
+    using reverse_iterator = std::reverse_iterator<iterator>;
+    using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+    ChunkedVector() {}
+    ChunkedVector(const ChunkedVector &other)
+    {
+        for(const T &v : other)
+            push_back(v);
+    }
+    ChunkedVector(ChunkedVector &&other) : m_chunks(std::move(other.m_chunks)),m_size(other.m_size)
+    {
+        other.m_chunks.clear();
+        other.m_size = 0;
+    }
+    ChunkedVector &operator=(const ChunkedVector &other)
+    {
+        if(this==&other)
+            return *this;
+        clear();
+        for(const T &v : other)
+            push_back(v);
+        return *this;
+    }
+    ChunkedVector &operator=(ChunkedVector &&other)
+    {
+        std::swap(m_chunks,other.m_chunks);
+        std::swap(m_size,other.m_size);
+        return *this;
+    }
+    ~ChunkedVector()
+    {
+        clear();
+    }
+
+    size_t      size() const { return m_size; }
+    bool        empty() const { return m_size==0; }
+
+    T &         operator[](size_t idx)
+    {
+        assert(idx<m_size);
+        return m_chunks[idx>>CHUNK_BITS][idx & (CHUNK_SIZE-1)];
+    }
+    const T &   operator[](size_t idx) const
+    {
+        assert(idx<m_size);
+        return m_chunks[idx>>CHUNK_BITS][idx & (CHUNK_SIZE-1)];
+    }
+    T &         front() { return (*this)[0]; }
+    const T &   front() const { return (*this)[0]; }
+    T &         back() { return (*this)[m_size-1]; }
+    const T &   back() const { return (*this)[m_size-1]; }
+
+    void push_back(const T &v)
+    {
+        new(allocateSlot()) T(v);
+        ++m_size;
+    }
+    template<class... Args>
+    T & emplace_back(Args&&... args)
+    {
+        T *res = new(allocateSlot()) T(std::forward<Args>(args)...);
+        ++m_size;
+        return *res;
+    }
+    void clear()
+    {
+        for(size_t i=0; i<m_size; ++i)
+            (*this)[i].~T();
+        for(T *chunk : m_chunks)
+            ::operator delete(chunk);
+        m_chunks.clear();
+        m_size = 0;
+    }
+
+    iterator                begin() { return iterator(this,0); }
+    iterator                end() { return iterator(this,m_size); }
+    const_iterator          begin() const { return const_iterator(this,0); }
+    const_iterator          end() const { return const_iterator(this,m_size); }
+    reverse_iterator        rbegin() { return reverse_iterator(end()); }
+    reverse_iterator        rend() { return reverse_iterator(begin()); }
+    const_reverse_iterator  rbegin() const { return const_reverse_iterator(end()); }
+    const_reverse_iterator  rend() const { return const_reverse_iterator(begin()); }
+private:
+    void *allocateSlot()
+    {
+        if((m_size>>CHUNK_BITS) == m_chunks.size())
+            m_chunks.push_back(static_cast<T *>(::operator new(CHUNK_SIZE*sizeof(T))));
+        return &m_chunks[m_size>>CHUNK_BITS][m_size & (CHUNK_SIZE-1)];
+    }
+};
@@ -0,0 +1,47 @@
+/*
+ * File:    DecodeCache.h
+ * Purpose: instructions of the whole program image, decoded before parsing
+ */
+#pragma once
+#include "icode.h"
+#include "error.h"
+
+#include <stdint.h>
+#include <vector>
+
+/** Results of the scanner for the instruction starts found by a linear sweep
+ * over the program image. build() splits the image into chunks and sweeps
+ * them on several threads; a chunk is swept from its first byte and gets back
+ * in step with the instruction stream after a few instructions. scan() looks
+ * addresses up here and decodes the ones that are missing.
+ * Addresses the parser later marks as data are dropped with invalidate(), so
+ * the cache does not serve bytes known to be data. */
+class DecodeCache
+{
+public:
+    typedef eErrorId (*Decoder)(uint32_t ip, ICODE &p);
+    static constexpr uint32_t MIN_CHUNK = 4096;    /* smaller images are swept on one thread */
+
+    /// Sweeps image offsets [0,size) with decode, on up to jobs threads
+    void    build(uint32_t size, int jobs, Decoder decode);
+    /// Copies the cached result for ip into p; false if ip is not cached
+    bool    lookup(uint32_t ip, ICODE &p, eErrorId &err) const;
+    /// Drops the instructions overlapping [start,start+len)
+    void    invalidate(uint32_t start, uint32_t len);
+    void    clear();
+    /// Sorted targets of the direct calls among the cached instructions
+    std::vector<uint32_t> callTargets() const;
+    bool    empty() const { return m_index.empty(); }
+    /// Number of addresses that can be looked up
+    size_t  size() const { return m_live; }
+private:
+    struct Entry
+    {
+        LLInst      inst;
+        eErrorId    err;
+    };
+    std::vector<uint32_t>   m_index;    /* offset -> m_entries index + 1, 0 if not cached */
+    std::vector<Entry>      m_entries;
+    size_t                  m_live=0;
+    uint32_t                m_maxBytes=1;   /* longest cached instruction */
+};
@@ -0,0 +1,44 @@
+/*
+ * File:    DominatorTree.h
+ * Purpose: dominator tree of a CFG numbered in reverse postorder (dfsLast)
+ */
+#pragma once
+#include <boost/range/iterator_range.hpp>
+#include <vector>
+
+/** Immediate dominators computed with the iterative algorithm of Cooper,
+ * Harvey and Kennedy ("A Simple, Fast Dominance Algorithm").
+ * Nodes are dfsLast indexes, the graph is given as predecessor lists in
+ * compressed form: the predecessors of node n are
+ * preds[predStart[n]] .. preds[predStart[n+1]-1].
+ * Works on irreducible graphs as well; the tree is numbered in pre and post
+ * order so that dominance queries take constant time. */
+class DominatorTree
+{
+public:
+    static constexpr int UNDEFINED = -1;
+    typedef boost::iterator_range<std::vector<int>::const_iterator> NodeRange;
+
+    void        build(int root, const std::vector<int> &predStart, const std::vector<int> &preds);
+    void        clear();
+    size_t      size() const { return m_idom.size(); }
+    /// Immediate dominator of node, UNDEFINED for the root and unreachable nodes
+    int         immedDom(int node) const;
+    /// Nodes immediately dominated by node, in ascending dfsLast order
+    NodeRange   children(int node) const;
+    /// true if a dominates b (every node dominates itself)
+    bool        dominates(int a, int b) const;
+    bool        reachable(int node) const { return m_pre[node]!=UNDEFINED; }
+    /// Number of sweeps over the graph the last build needed to converge
+    int         passes() const { return m_passes; }
+private:
+    int         intersect(int a, int b) const;
+    void        numberTree(int root);
+
+    std::vector<int>    m_idom;         /* immediate dominator, root maps to itself */
+    std::vector<int>    m_childStart;   /* children of n: m_childList[m_childStart[n]..m_childStart[n+1]) */
+    std::vector<int>    m_childList;
+    std::vector<int>    m_pre;          /* preorder number in the dominator tree    */
+    std::vector<int>    m_post;         /* postorder number in the dominator tree   */
+    int                 m_passes=0;
+};
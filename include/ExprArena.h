@@ -0,0 +1,75 @@
+/*
+ * File:    ExprArena.h
+ * Purpose: per procedure storage for expression trees (Expr nodes)
+ */
+#pragma once
+#include <cstddef>
+#include <stdint.h>
+#include <unordered_map>
+#include <vector>
+
+struct Constant;
+struct Expr;
+
+/** Owns the Expr nodes created while a procedure is analysed.
+ * Every Expr allocated on a thread that has an active Scope comes from that
+ * scope's arena; nodes deleted during analysis are reused for later nodes of
+ * the same size, and the whole arena is dropped after the procedure's code has
+ * been written. Without an active Scope nodes come from the heap as usual.
+ * Constants are hash-consed: Constant::Create returns one shared node per
+ * (value,size) pair, and such nodes are only ever released with the arena,
+ * see Expr::destroy. */
+class ExprArena
+{
+    static constexpr size_t GRANULE = 16;       /* node sizes are rounded up to this */
+    static constexpr size_t MAX_NODE = 128;     /* larger nodes come from the heap */
+    static constexpr size_t FIRST_CHUNK = 256;
+    static constexpr size_t MAX_CHUNK = 16384;
+public:
+    ExprArena() {}
+    ExprArena(const ExprArena &) {}
+    ExprArena &operator=(const ExprArena &) { return *this; }
+    ~ExprArena()
+    {
+        release();
+    }
+    /** Makes arena the target of Expr allocations on this thread, until the
+     * Scope is destroyed. Scopes nest. */
+    class Scope
+    {
+        ExprArena *m_prev;
+    public:
+        explicit Scope(ExprArena &arena);
+        ~Scope();
+        Scope(const Scope &) = delete;
+        Scope &operator=(const Scope &) = delete;
+    };
+    /// Arena of the innermost Scope on this thread, nullptr if there is none
+    static ExprArena *current();
+
+    static void *   allocateNode(size_t size);
+    static void     freeNode(void *ptr, size_t size);
+    /// true for hash-consed nodes, which are shared between expression trees
+    static bool     isShared(const Expr *e);
+
+    /// The shared constant node for given value and size
+    Constant *      constant(uint32_t value, uint8_t size);
+    /// Number of nodes currently alive in the arena
+    size_t          size() const { return m_live; }
+    /// Drops all nodes at once, without running their destructors
+    void            release();
+private:
+    void *          allocate(size_t size);
+    void            recycle(void *block, size_t size);
+
+    struct FreeBlock
+    {
+        FreeBlock * next;
+    };
+    std::vector<char *>     m_chunks;
+    char *                  m_top=nullptr;      /* free space in the last chunk */
+    size_t                  m_left=0;
+    size_t                  m_live=0;
+    FreeBlock *             m_free[MAX_NODE/GRANULE+1] = {};    /* recycled blocks by size class */
+    std::unordered_map<uint64_t,Constant *> m_constants;        /* (value<<8)|size -> shared node */
+};
@@ -0,0 +1,49 @@
+/*
+ * File:    MemoryMap.h
+ * Purpose: what the bytes of the program image have been found to be
+ */
+#pragma once
+#include <cstddef>
+#include <stdint.h>
+#include <map>
+#include <vector>
+
+/** Type bits (BM_DATA, BM_CODE) of each byte of the program image, kept as
+ * runs of bytes with the same bits. Bits are only ever added; set() and the
+ * range queries take O(log n) in the number of runs, plus the runs touched.
+ * Neighbouring runs always differ, so all the code of a procedure usually
+ * ends up as a single run. */
+class MemoryMap
+{
+public:
+    struct Region
+    {
+        uint32_t    start;
+        uint32_t    end;        /* one past the last byte */
+        uint8_t     type;
+    };
+    /// Makes [0,size) a single run with no bits set
+    void        reset(uint32_t size);
+    uint32_t    size() const { return m_size; }
+    /// Adds the bits of type to [start,start+len), clipped to the map
+    void        set(uint32_t start, uint32_t len, uint8_t type);
+    /// Bits of the byte at off, 0 past the end of the map
+    uint8_t     at(uint32_t off) const;
+    /// true if the byte at off has any of the bits of type
+    bool        test(uint32_t off, uint8_t type) const { return (at(off) & type) != 0; }
+    /// true if any byte of [start,start+len) has any of the bits of type
+    bool        any(uint32_t start, uint32_t len, uint8_t type) const;
+    /// End of the run holding off, i.e. the first byte after it with other bits
+    uint32_t    runEnd(uint32_t off) const;
+    /// The runs with any of the bits of type, or with no bits if type is 0
+    std::vector<Region> regions(uint8_t type) const;
+    /// Number of runs, for statistics
+    size_t      runCount() const { return m_runs.size(); }
+private:
+    typedef std::map<uint32_t,uint8_t> Runs;   /* run start -> bits of the run */
+    Runs::iterator  split(uint32_t pos);
+    Runs::const_iterator find(uint32_t off) const;
+
+    Runs        m_runs;
+    uint32_t    m_size=0;
+};
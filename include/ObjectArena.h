@@ -0,0 +1,66 @@
+/*
+ * File:    ObjectArena.h
+ * Purpose: chunked storage for objects that are all released together
+ */
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <new>
+#include <utility>
+#include <vector>
+
+/** Allocates objects of type T in chunks and destroys all of them at once.
+ * Objects never move and are never freed one by one. Chunks start small and
+ * double in size, so that arenas of small procedures stay small.
+ * A type with private constructors has to befriend ObjectArena. */
+template<class T>
+class ObjectArena
+{
+    static constexpr size_t FIRST_CHUNK = 8;
+    static constexpr size_t MAX_CHUNK = 256;
+    struct Chunk
+    {
+        T *     storage;
+        size_t  capacity;
+        size_t  used;
+    };
+    std::vector<Chunk>  m_chunks;
+    size_t              m_size=0;
+public:
+    ObjectArena() {}
+    ObjectArena(const ObjectArena &) = delete;
+    ObjectArena &operator=(const ObjectArena &) = delete;
+    ~ObjectArena()
+    {
+        release();
+    }
+    /// Number of objects currently alive in the arena
+    size_t size() const { return m_size; }
+
+    template<class... Args>
+    T *create(Args&&... args)
+    {
+        if(m_chunks.empty() or m_chunks.back().used==m_chunks.back().capacity)
+        {
+            size_t capacity = m_chunks.empty() ? FIRST_CHUNK : std::min(2*m_chunks.back().capacity,MAX_CHUNK);
+            m_chunks.push_back(Chunk{static_cast<T *>(::operator new(capacity*sizeof(T))),capacity,0});
+        }
+        Chunk &chunk(m_chunks.back());
+        T *res = new(chunk.storage+chunk.used) T(std::forward<Args>(args)...);
+        ++chunk.used;
+        ++m_size;
+        return res;
+    }
+    /// Destroys all objects and returns their memory
+    void release()
+    {
+        for(Chunk &chunk : m_chunks)
+        {
+            for(size_t i=0; i<chunk.used; ++i)
+                chunk.storage[i].~T();
+            ::operator delete(chunk.storage);
+        }
+        m_chunks.clear();
+        m_size = 0;
+    }
+};
@@ -5,8 +5,12 @@
 #include "icode.h"
 #include "StackFrame.h"
 #include "CallConvention.h"
+#include "DominatorTree.h"
+#include "ExprArena.h"
+#include "error.h"
 
 #include <QtCore/QString>
+#include <atomic>
 #include <bitset>
 #include <map>
 
@@ -20,6 +24,8 @@ struct Disassembler;
 struct Function;
 struct CALL_GRAPH;
 struct PROG;
+struct ParseTrace;
+class ParseWorklist;
 
 struct Function;
 
@@ -49,6 +55,15 @@ enum PROC_FLAGS
 //#define CALL_MASK    0xFFFF9FFF /* Masks off CALL_C and CALL_PASCAL		 	*/
 };
 
+/* Procedure flags word. Updates are atomic, because with -j the flags of a
+ * callee are read while the callee itself can be analysed on another thread */
+struct ProcFlags : public std::atomic<uint32_t>
+{
+    ProcFlags(uint32_t v=0) : std::atomic<uint32_t>(v) {}
+    ProcFlags(const ProcFlags &other) : std::atomic<uint32_t>(other.load()) {}
+    ProcFlags &operator=(const ProcFlags &other) { store(other.load()); return *this; }
+    ProcFlags &operator=(uint32_t v) { store(v); return *this; }
+};
 struct FunctionType
 {
     bool m_vararg=false;
@@ -68,6 +83,12 @@ struct JumpTable
     size_t entrySize() { return 2;}
     void pruneEntries(uint16_t cs);
 };
+/* Work done by liveRegAnalysis, reported by -s */
+struct LiveAnalysisStats
+{
+    int passes=0;       /* passes over the worklist                 */
+    int blockVisits=0;  /* basic blocks (re)evaluated               */
+};
 class FunctionCfg
 {
     std::list<BB*> m_listBB;      /* Ptr. to BB list/CFG                  	 */
@@ -87,6 +108,36 @@ public:
         fprintf(stderr,"Attempt to perform node splitting: NOT IMPLEMENTED\n");
     }
     void push_back(BB *v) { m_listBB.push_back(v);}
+    void clear() { m_listBB.clear(); }
+};
+/* Owner of the graph objects of one procedure. The code BBs live as long as
+ * the Function (or until freeCFG); the BBs of the derived sequence of graphs
+ * are released in one shot at the end of controlFlowAnalysis.
+ * Copying a Function does not copy its graph. */
+struct CfgArena
+{
+    ObjectArena<BB>     cfgBlocks;      /* BBs of m_actual_cfg, removed ones included */
+    ObjectArena<BB>     derivedBlocks;  /* interval BBs and interval analysis markers */
+    CfgArena() {}
+    CfgArena(const CfgArena &) {}
+    CfgArena &operator=(const CfgArena &) { return *this; }
+};
+/* Interprocedural effects of buildCFG running on a worker thread (udm -j).
+ * They are applied in procedure order once all workers are done, which gives
+ * the same result as a sequential run. */
+struct DeferredUpdates
+{
+    struct CallInfo
+    {
+        Function *      proc;
+        int16_t         cbParam;
+        CConv::Type     conv;
+    };
+    std::vector<CallInfo>   callInfo;   /* setCallInfo calls, in order          */
+    bool            checkParams=false;  /* checkParamBytes call, after callInfo */
+    int16_t         paramBytes=0;       /* and its bytes of parameters          */
+    std::vector<iICODE>     calls;      /* HLI_CALLs taking cb from the callee  */
+    DiagnosticLog           log;        /* output of the worker                 */
 };
 struct Function
 {
@@ -110,7 +161,7 @@ public:
     QString         name;      /* Meaningful name for this proc     	 */
     STATE           state;     /* Entry state                          	 */
     int          depth;     /* Depth at which we found it - for printing */
-    uint32_t     flg;       /* Combination of Icode & Proc flags    	 */
+    ProcFlags    flg;       /* Combination of Icode & Proc flags    	 */
     int16_t      cbParam;   /* Probable no. of bytes of parameters  	 */
     STKFRAME     args;      /* Array of arguments                   	 */
     LOCAL_ID	 localId;   /* Local identifiers                         */
@@ -119,7 +170,10 @@ public:
         /* Icodes and control flow graph */
     CIcodeRec	 Icode;     /* Object with ICODE records                 */
     FunctionCfg     m_actual_cfg;
+    CfgArena        m_arena;    /* Owns all BBs of this procedure */
+    ExprArena       m_exprs;    /* Owns the expression trees, freed after codeGen */
     std::vector<BB*> m_dfsLast;
+    DominatorTree   m_domTree;  /* Dominators over dfsLast indexes, see findImmedDom */
     std::map<int,BB*> m_ip_to_bb;
 //                           * (reverse postorder) order            	 */
     size_t        numBBs;    /* Number of BBs in the graph cfg       	 */
@@ -129,6 +183,8 @@ public:
     LivenessSet     liveIn;	/* Registers used before defined                 */
     LivenessSet     liveOut;	/* Registers that may be used in successors	 */
     bool            liveAnal;	/* Procedure has been analysed already		 */
+    LiveAnalysisStats liveStats; /* Cost of the last liveRegAnalysis		 */
+    DeferredUpdates *m_deferred=nullptr; /* Set while on a udm worker thread */
 
     virtual ~Function() {
         delete type;
@@ -145,6 +201,9 @@ public:
     }
     CConv *callingConv() const { return m_call_conv;}
     void callingConv(CConv::Type v);
+    void setCallInfo(Function *target, int16_t cbParam, CConv::Type conv);
+    void checkParamBytes(int16_t delta);
+    void applyDeferredUpdates();
 
 //    bool anyFlagsSet(uint32_t t) { return (flg&t)!=0;}
     bool hasRegArgs() const { return (flg & REG_ARGS)!=0;}
@@ -162,9 +221,11 @@ public:
     void markImpure();
     void findImmedDom();
     void FollowCtrl(CALL_GRAPH *pcallGraph, STATE *pstate);
+    void FollowCtrlConcurrent(STATE *pstate);
+    bool parsePath(ParseWorklist &work, ParseTrace &trace);
     void process_operands(ICODE &pIcode, STATE *pstate);
-    bool process_JMP(ICODE &pIcode, STATE *pstate, CALL_GRAPH *pcallGraph);
-    bool process_CALL(ICODE &pIcode, CALL_GRAPH *pcallGraph, STATE *pstate);
+    bool process_JMP(ICODE &pIcode, ParseTrace &trace, ParseWorklist &work);
+    bool process_CALL(ICODE &pIcode, ParseTrace &trace, ParseWorklist &work);
     void freeCFG();
     void codeGen(QIODevice & fs);
     void mergeFallThrough(BB *pBB);
@@ -187,7 +248,7 @@ public:
     ICODE *translate_XCHG(LLInst *ll, ICODE &r_Icode);
 protected:
     void extractJumpTableRange(ICODE& pIcode, STATE *pstate, JumpTable &table);
-    bool followAllTableEntries(JumpTable &table, uint32_t cs, ICODE &pIcode, CALL_GRAPH *pcallGraph, STATE *pstate);
+    bool followAllTableEntries(JumpTable &table, uint32_t cs, ICODE &pIcode, ParseTrace &trace, ParseWorklist &work);
     bool removeInEdge_Flag_and_ProcessLatch(BB *pbb, BB *a, BB *b);
     bool Case_X_and_Y(BB* pbb, BB* thenBB, BB* elseBB);
     bool Case_X_or_Y(BB* pbb, BB* thenBB, BB* elseBB);
@@ -217,8 +278,8 @@ protected:
     void addOutEdgesForConditionalJump(BB*        pBB, int next_ip, LLInst *ll);
     
 private:
-    bool    decodeIndirectJMP(ICODE &pIcode, STATE *pstate, CALL_GRAPH *pcallGraph);
-    bool    decodeIndirectJMP2(ICODE &pIcode, STATE *pstate, CALL_GRAPH *pcallGraph);
+    bool    decodeIndirectJMP(ICODE &pIcode, ParseTrace &trace, ParseWorklist &work);
+    bool    decodeIndirectJMP2(ICODE &pIcode, ParseTrace &trace, ParseWorklist &work);
 };
 typedef std::list<Function> FunctionListType;
 typedef FunctionListType lFunction;
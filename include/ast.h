@@ -9,6 +9,8 @@
 #include "Enums.h"
 #include "msvc_fixes.h"
 #include "boost_fwd.h"
+#include "ChunkedVector.h"
+#include "ExprArena.h"
 
 #include <stdint.h>
 #include <cstring>
@@ -35,7 +37,7 @@ struct ICODE;
 struct LLInst;
 struct LLOperand;
 struct ID;
-typedef std::list<ICODE>::iterator iICODE;
+typedef ChunkedVector<ICODE>::iterator iICODE;
 
 typedef boost::iterator_range<iICODE> rICODE;
 #include "IdentType.h"
@@ -58,6 +60,15 @@ public:
     }
     /** Recursively deallocates the abstract syntax tree rooted at *exp */
     virtual ~Expr() {}
+    /** Nodes come from the active ExprArena, if there is one */
+    static void *operator new(size_t size) { return ExprArena::allocateNode(size); }
+    static void operator delete(void *ptr, size_t size) { ExprArena::freeNode(ptr,size); }
+    /** Deletes the tree rooted at e; shared (hash-consed) nodes are left to their arena */
+    static void destroy(Expr *e)
+    {
+        if(e and not ExprArena::isShared(e))
+            delete e;
+    }
 public:
     virtual QString walkCondExpr (Function * pProc, int* numLoc) const=0;
     virtual Expr *inverse() const=0; // return new COND_EXPR that is invarse of this
@@ -96,7 +107,7 @@ struct UnaryOperator : public Expr
     }
     ~UnaryOperator()
     {
-        delete unaryExp;
+        destroy(unaryExp);
         unaryExp=nullptr;
     }
 public:
@@ -127,9 +138,9 @@ struct BinaryOperator : public Expr
     }
     ~BinaryOperator()
     {
-        assert(m_lhs!=m_rhs or m_lhs==nullptr);
-        delete m_lhs;
-        delete m_rhs;
+        assert(m_lhs!=m_rhs or m_lhs==nullptr or ExprArena::isShared(m_lhs));
+        destroy(m_lhs);
+        destroy(m_rhs);
         m_lhs=m_rhs=nullptr;
     }
     static BinaryOperator *Create(condOp o,Expr *l,Expr *r)
@@ -264,8 +275,18 @@ struct Constant : public AstIdent
         kte.kte = _kte;
         kte.size = size;
     }
+    /// Shared constant node from the active ExprArena, a new one without it
+    static Constant *Create(uint32_t _kte, uint8_t size)
+    {
+        ExprArena *arena = ExprArena::current();
+        if(arena)
+            return arena->constant(_kte,size);
+        return new Constant(_kte,size);
+    }
     virtual Expr *clone() const
     {
+        if(ExprArena::isShared(this))
+            return const_cast<Constant *>(this);
         return new Constant(*this);
     }
     QString walkCondExpr(Function *pProc, int *numLoc) const;
@@ -41,6 +41,8 @@ struct OPTION
     bool Calls;         /* Follow register indirect calls */
     QString	filename;			/* The input filename */
     uint32_t CustomEntryPoint;
+    int     Jobs;               /* Threads used for per procedure analysis */
+    bool    PreDecode;          /* Decode the whole image before parsing */
 };
 
 extern OPTION option;       /* Command line options             */
@@ -66,9 +68,10 @@ struct STATS
         int		numHLIcode; 	/* number of high-level Icode instructions     */
         int		totalLL;        /* total number of low-level Icode insts       */
         int		totalHL;        /* total number of high-level Icod insts       */
+        int		totalLiveVisits;/* total number of BB visits in live analysis  */
 };
 
-extern STATS stats; /* Icode statistics */
+extern thread_local STATS stats; /* Icode statistics, per udm worker thread */
 
 
 /**** Global function prototypes ****/
@@ -79,17 +82,18 @@ BB *    newBB(BB *, int, int, uint8_t, int, Function *);    /* graph.c      */
 void    BackEnd(CALL_GRAPH *);              /* backend.c    */
 extern char   *cChar(uint8_t c);                            /* backend.c    */
 eErrorId scan(uint32_t ip, ICODE &p);                       /* scanner.c    */
+void    predecode(int jobs);                                /* scanner.c    */
 void    parse (CALL_GRAPH * *);                             /* parser.c     */
 
-extern int     strSize (const uint8_t *, char);             /* parser.c     */
+extern int     strSize (uint32_t, char);                    /* parser.c     */
 //void    disassem(int pass, Function * pProc);             /* disassem.c   */
 void    interactDis(Function *, int initIC);       /* disassem.c   */
 bool    JmpInst(llIcode opcode);                            /* idioms.c     */
-queue::iterator  appendQueue(queue &Q, BB *node);           /* reducible.c  */
 
 bool    SetupLibCheck(void);                                /* chklib.c     */
 void    CleanupLibCheck(void);                              /* chklib.c     */
 bool    LibCheck(Function &p);                              /* chklib.c     */
+void    LibCheckBatch(const std::vector<uint32_t> &entries); /* chklib.c     */
 
 
 /* Exported functions from hlicode.c */
@@ -6,6 +6,9 @@
 ***************************************************************************
 */
 #pragma once
+#include <cstdio>
+#include <string>
+#include <vector>
 
 /* These definitions refer to errorMessage in error.c */
 enum eErrorId
@@ -37,3 +40,30 @@ enum eErrorId
 void fatalError(eErrorId errId, ...);
 void reportError(eErrorId errId, ...);
 
+/* Diagnostics printed by a worker thread of udm() or of the parser (-j) are
+ * kept in its DiagnosticLog, and replayed later in the order a sequential run
+ * would have printed them. Covers dccPrintf/dccFprintf and the Qt message functions. */
+class DiagnosticLog
+{
+    struct Entry
+    {
+        FILE *      stream;     /* nullptr for Qt messages  */
+        int         msgType;    /* QtMsgType of Qt messages */
+        std::string text;
+    };
+    std::vector<Entry> m_entries;
+    size_t m_replayed=0;    /* entries printed by replayUpTo */
+public:
+    void replay();
+    /// Prints the entries before position upTo that were not printed yet
+    void replayUpTo(size_t upTo);
+    size_t size() const { return m_entries.size(); }
+    /// Routes diagnostics of the calling thread to log, or straight out if log is nullptr
+    static void capture(DiagnosticLog *log);
+    void append(FILE *stream, int msgType, const std::string &text)
+    {
+        m_entries.push_back(Entry{stream,msgType,text});
+    }
+};
+int dccPrintf(const char *format, ...);
+int dccFprintf(FILE *stream, const char *format, ...);
@@ -5,8 +5,11 @@
  ****************************************************************************
  */
 #pragma once
+#include "ChunkedVector.h"
+
 #include <stdint.h>
 #include <list>
+#include <vector>
 
 struct Function;
 /* Types of basic block nodes */
@@ -67,19 +70,16 @@ enum eEdgeType {
 
 struct BB;
 /* Interval structure */
-using queue = std::list<BB *>;
+using queue = std::vector<BB *>;
 
 struct interval
 {
     uint8_t         numInt=0;         /* # of the interval    */
     uint8_t         numOutEdges=0;    /* Number of out edges  */
-    queue           nodes;         /* Nodes of the interval*/
-    queue::iterator currNode;      /* Current node     */
-    interval *      next=0;          /* Next interval    */
+    queue           nodes;         /* Nodes of the interval, in interval order */
+    size_t          currNode=0;    /* Index of the next unprocessed node */
     BB *            firstOfInt();
-                    interval() : currNode(nodes.end()){
-                    }
-    void            appendNodeInt(queue &pqH, BB *node);
+    void            appendNodeInt(BB *node);
 };
 
 
@@ -87,9 +87,11 @@ struct interval
 struct derSeq_Entry
 {
     BB *                Gi=nullptr;        /* Graph pointer        */
-    std::list<interval *> m_intervals;
-    interval *          Ii=nullptr;        /* Interval list of Gi  */
-    ~derSeq_Entry();
+    ChunkedVector<interval> m_intervals;   /* Intervals of Gi, addresses are kept in BB::inInterval */
+    derSeq_Entry() {}
+    derSeq_Entry(const derSeq_Entry &) = delete;
+    derSeq_Entry(derSeq_Entry &&) = default;
+    derSeq_Entry &operator=(derSeq_Entry &&) = default;
 public:
     void findIntervals(Function *c);
 };
@@ -97,7 +99,6 @@ class derSeq
 {
 public:
     void display();
-    std::list<derSeq_Entry> entries;
+    std::vector<derSeq_Entry> entries;
 };
-void    freeDerivedSeq(derSeq &derivedG);                   /* reducible.c  */
 
@@ -5,11 +5,11 @@
 #pragma once
 #include "msvc_fixes.h"
 #include "BinaryImage.h"
-#include "libdis.h"
 #include "Enums.h"
 #include "state.h"			// State depends on INDEXBASE, but later need STATE
 #include "CallConvention.h"
 #include "boost_fwd.h"
+#include "ChunkedVector.h"
 
 #include <QtCore/QString>
 
@@ -18,6 +18,7 @@
 #include <list>
 #include <bitset>
 #include <set>
+#include <unordered_map>
 //#include <algorithm>
 #include <initializer_list>
 
@@ -31,44 +32,41 @@ class CIcodeRec;
 struct ICODE;
 struct bundle;
 
-using iICODE = std::list<ICODE>::iterator;
-using riICODE = std::list<ICODE>::reverse_iterator;
+using iICODE = ChunkedVector<ICODE>::iterator;
+using riICODE = ChunkedVector<ICODE>::reverse_iterator;
 using rCODE = boost::iterator_range<iICODE>;
 
+/* Set of registers, one bit per eReg value */
 struct LivenessSet
 {
-    std::set<eReg> registers;
+    static_assert(LAST_REG<=32,"eReg values have to fit in the register mask");
+    uint32_t registers=0;
 public:
-    LivenessSet(const std::initializer_list<eReg> &init) : registers(init) {}
-    LivenessSet() {}
-    LivenessSet(const LivenessSet &other) : registers(other.registers)
+    LivenessSet(const std::initializer_list<eReg> &init)
     {
+        for(eReg r : init)
+            registers |= bit(r);
     }
+    LivenessSet() {}
     void reset()
     {
-        registers.clear();
+        registers = 0;
     }
-
-    //    LivenessSet(LivenessSet &&other) : LivenessSet()
-    //    {
-    //        swap(*this,other);
-    //    }
-    LivenessSet &operator=(LivenessSet other)
+    LivenessSet &operator|=(const LivenessSet &other)
     {
-        swap(*this,other);
+        registers |= other.registers;
         return *this;
     }
-    friend void swap(LivenessSet& first, LivenessSet& second) // nothrow
+    LivenessSet &operator&=(const LivenessSet &other)
     {
-        std::swap(first.registers, second.registers);
+        registers &= other.registers;
+        return *this;
     }
-    LivenessSet &operator|=(const LivenessSet &other)
+    LivenessSet &operator-=(const LivenessSet &other)
     {
-        registers.insert(other.registers.begin(),other.registers.end());
+        registers &= ~other.registers;
         return *this;
     }
-    LivenessSet &operator&=(const LivenessSet &other);
-    LivenessSet &operator-=(const LivenessSet &other);
     LivenessSet operator-(const LivenessSet &other) const
     {
         return LivenessSet(*this) -= other;
@@ -83,7 +81,7 @@ public:
     }
     bool any() const
     {
-        return not registers.empty();
+        return registers!=0;
     }
     bool operator==(const LivenessSet &other) const
     {
@@ -95,11 +93,12 @@ public:
     LivenessSet &addReg(int r);
     bool testReg(int r) const
     {
-        return registers.find(eReg(r))!=registers.end();
+        return (registers & bit(r))!=0;
     }
     bool testRegAndSubregs(int r) const;
     LivenessSet &clrReg(int r);
 private:
+    static uint32_t bit(int r) { return uint32_t(1)<<r; }
     void postProcessCompositeRegs();
 };
 
@@ -289,7 +288,7 @@ struct LLOperand
     {
         return not (*this == LLOperand());
     }
-    void addProcInformation(int param_count, CConv::Type call_conv);
+    void addProcInformation(Function *caller, int param_count, CConv::Type call_conv);
     bool isImmediate() const { return immed;}
     void setImmediate(bool x) { immed=x;}
     bool compound() const {return is_compound;} // dx:ax pair
@@ -435,7 +434,6 @@ protected:
     MachineBasicBlock * Parent;      	/* BB to which this icode belongs   */
     bool                invalid;        /* Has no HIGH_LEVEL equivalent     */
 public:
-    x86_insn_t insn;
     template<int FLAG>
     struct FlagFilter
     {
@@ -483,8 +481,8 @@ public:
         struct Use
         {
             int Reg; // used register
-            std::vector<std::list<ICODE>::iterator> uses; // use locations [MAX_USES]
-            void removeUser(std::list<ICODE>::iterator us)
+            std::vector<iICODE> uses; // use locations [MAX_USES]
+            void removeUser(iICODE us)
             {
                 // ic is no no longer an user
                 auto iter=std::find(uses.begin(),uses.end(),us);
@@ -506,7 +504,7 @@ public:
         {
             return idx[regIdx].uses.size();
         }
-        void recordUse(int regIdx,std::list<ICODE>::iterator location)
+        void recordUse(int regIdx,iICODE location)
         {
             idx[regIdx].uses.push_back(location);
         }
@@ -514,7 +512,7 @@ public:
         {
             idx[regIdx].uses.erase(idx[regIdx].uses.begin()+use_idx);
         }
-        void remove(int regIdx,std::list<ICODE>::iterator ic)
+        void remove(int regIdx,iICODE ic)
         {
             Use &u(idx[regIdx]);
             u.removeUser(ic);
@@ -594,8 +592,10 @@ public:
 class CIcodeRec
 {
 public:
-    using iterator = std::list<ICODE>::iterator;
+    using iterator = ChunkedVector<ICODE>::iterator;
     CIcodeRec();	// Constructor
+    CIcodeRec(const CIcodeRec &other);
+    CIcodeRec & operator=(const CIcodeRec &other);
 
     ICODE *     addIcode(ICODE *pIcode);
     void        SetInBB(rCODE &rang, BB* pnewBB);
@@ -603,6 +603,11 @@ public:
     iterator    labelSrch(uint32_t target);
     ICODE *     GetIcode(size_t ip);
     bool        alreadyDecoded(uint32_t target);
+    void        clear();
+    /// Has to be called after labels of entries were changed in place
+    void        rebuildLabelIndex();
 
-    std::list<ICODE> entries;
+    ChunkedVector<ICODE> entries;
+private:
+    std::unordered_map<uint32_t,iterator> m_labels; /* label -> first icode with that label */
 };
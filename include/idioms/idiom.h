@@ -1,12 +1,13 @@
 #pragma once
 
-#include <list>
+#include "ChunkedVector.h"
+
 #include <stdint.h>
 
 struct ICODE;
 struct Function;
 
-using iICODE=std::list<ICODE>::iterator;
+using iICODE=ChunkedVector<ICODE>::iterator;
 
 struct Idiom
 {
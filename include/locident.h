@@ -10,6 +10,7 @@
 #include "types.h"
 #include "Enums.h"
 #include "machine_x86.h"
+#include "ChunkedVector.h"
 
 #include <QtCore/QString>
 #include <stdint.h>
@@ -23,7 +24,7 @@ struct Expr;
 struct AstIdent;
 struct ICODE;
 struct LLInst;
-using iICODE=std::list<ICODE>::iterator;
+using iICODE=ChunkedVector<ICODE>::iterator;
 using IDX_ARRAY = std::vector<iICODE>;
 
 inline bool inList(const IDX_ARRAY &arr,iICODE idx);
@@ -4,9 +4,11 @@
 #include <cassert>
 #include <list>
 #include <unordered_set>
+#include <unordered_map>
 #include <QtCore/QString>
 #include "symtab.h"
 #include "BinaryImage.h"
+#include "DecodeCache.h"
 #include "Procedure.h"
 class QString;
 class SourceMachine;
@@ -33,6 +35,7 @@ public:
             FunctionListType pProcList;
             CALL_GRAPH * callGraph;	/* Pointer to the head of the call graph     */
             PROG        prog;   		/* Loaded program image parameters  */
+            DecodeCache decoded;        /* Image decoded before parsing (--predecode) */
                         // no copies
                         Project(const Project&) = delete;
     const   Project &   operator=(const Project & l) =delete;
@@ -49,7 +52,7 @@ public:
             QString     output_name(const char *ext);
             ilFunction  funcIter(Function *to_find);
             ilFunction  findByEntry(uint32_t entry);
-            ilFunction  createFunction(FunctionType *f, const QString & name);
+            ilFunction  createFunction(FunctionType *f, const QString & name, uint32_t entry);
             bool        valid(ilFunction iter);
 
             int         getSymIdxByAddr(uint32_t adr);
@@ -66,6 +69,9 @@ public:
     const   FunctionListType &functions() const { return pProcList; }
             FunctionListType &functions()       { return pProcList; }
 protected:
+            /* Lookup indexes into pProcList, maintained by createFunction */
+            std::unordered_map<uint32_t,ilFunction>         m_entryIndex;   /* procEntry -> proc */
+            std::unordered_map<const Function *,ilFunction> m_procIndex;    /* Function * -> proc */
             void        initialize();
             void        writeGlobSymTable();
 };
@@ -10,3 +10,4 @@
 struct ICODE;
 /* Extracts reg bits from middle of mod-reg-rm uint8_t */
 extern eErrorId scan(uint32_t ip, ICODE &p);
+extern void predecode(int jobs);
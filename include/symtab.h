@@ -8,8 +8,10 @@
 #include "msvc_fixes.h"
 
 #include <QtCore/QString>
+#include <algorithm>
 #include <string>
 #include <stdint.h>
+#include <unordered_map>
 #include <vector>
 
 struct Expr;
@@ -61,23 +63,47 @@ struct STKSYM : public SymbolCommon
 template<class T>
 class SymbolTableCommon
 {
+    typedef typename T::tLabel tLabel;
     std::vector<T> storage;
+    /* label -> index of the first entry with that label, kept up to date by
+     * push_back once enableLabelIndex was called; small tables are scanned */
+    std::unordered_map<tLabel,size_t> m_labelIndex;
+    bool m_indexed=false;
 public:
     typedef typename std::vector<T>::iterator iterator;
     typedef typename std::vector<T>::const_iterator const_iterator;
 
-    iterator findByLabel(typename T::tLabel lab)
+    iterator findByLabel(tLabel lab)
     {
+        if(m_indexed)
+        {
+            auto pos = m_labelIndex.find(lab);
+            return (pos==m_labelIndex.end()) ? storage.end() : storage.begin()+pos->second;
+        }
         auto iter = std::find_if(storage.begin(),storage.end(),
                                  [lab](T &s)->bool {return s.label==lab;});
         return iter;
     }
-    const_iterator findByLabel(typename T::tLabel lab) const
+    const_iterator findByLabel(tLabel lab) const
     {
+        if(m_indexed)
+        {
+            auto pos = m_labelIndex.find(lab);
+            return (pos==m_labelIndex.end()) ? storage.cend() : storage.cbegin()+pos->second;
+        }
         auto iter = std::find_if(storage.begin(),storage.end(),
                                  [lab](const T &s)->bool {return s.label==lab;});
         return iter;
     }
+    /// Switches findByLabel to a hashed lookup. Entry labels must not be
+    /// changed after insertion while the index is enabled.
+    void enableLabelIndex()
+    {
+        m_indexed = true;
+        m_labelIndex.clear();
+        for(size_t idx=0; idx<storage.size(); ++idx)
+            m_labelIndex.emplace(storage[idx].label,idx);
+    }
     const T& operator[](size_t idx) const {
         return storage[idx];
     }
@@ -86,6 +112,8 @@ public:
     }
 
     void push_back(const T &entry) {
+        if(m_indexed)
+            m_labelIndex.emplace(entry.label,storage.size());
         storage.push_back(entry);
     }
     iterator begin() { return storage.begin(); }
@@ -105,8 +133,10 @@ class SYMTAB : public SymbolTableCommon<SYM>
 {
 
 public:
+    SYMTAB() { enableLabelIndex(); }
     void updateSymType(uint32_t symbol, const TypeContainer &tc);
     SYM *updateGlobSym(uint32_t operand, int size, uint16_t duFlag, bool &inserted_new);
+    static SYM newGlobSym(uint32_t operand, int size, uint16_t duFlag);
 };
 struct Function;
 struct SYMTABLE
@@ -37,7 +37,7 @@
 #define LH_SIGNED(p) (((uint8_t *)(p))[0] + (((char *)(p))[1] << 8))
 
 /* Macro tests bit b for type t in prog.map */
-#define BITMAP(b, t)  (prog.map[(b) >> 2] & ((t) << (((b) & 3) << 1)))
+#define BITMAP(b, t)  (prog.map.test((b), (t)))
 
 /* Macro to convert a segment, offset definition into a 20 bit address */
 #define opAdr(seg,off)  ((seg << 4) + off)
@@ -0,0 +1,30 @@
+#!/bin/bash
+# Decompiles the regression inputs with -j 1, which parses with FollowCtrl and
+# analyses the procedures in order, and with -j JOBS, which uses the
+# concurrent parser and the udm thread pool, and compares the two: the
+# listings (.a1, .a2: procedure list and icodes), the C output and the call
+# graph and diagnostics printed on stdout and stderr.
+# Usage: jobs_regression.sh DCC [JOBS [INPUTS]], run from the dcc directory.
+DCC=$(realpath "$1")
+JOBS=${2:-4}
+INPUTS=${3:-tests/inputs_base}
+OUT=$(mktemp -d)
+trap 'rm -rf "$OUT"' EXIT
+
+run() {
+	local dir=$OUT/$1
+	shift
+	mkdir -p $dir
+	cp $INPUTS/*.EXE $dir/
+	for f in $dir/*.EXE; do
+		b=$(basename $f)
+		$DCC "$@" -a 1 -o$dir/$b.a1 $f >/dev/null 2>>$dir/stderr
+		$DCC "$@" -a 2 -s -c -o$dir/$b.a2 $f >>$dir/stdout 2>>$dir/stderr
+		$DCC "$@" -s -c -o$dir/$b $f >>$dir/stdout 2>>$dir/stderr
+	done
+	# Only the directory of the input and output may differ between the runs
+	sed -i "s|$dir|OUT|g" $dir/stdout $dir/stderr $dir/*.b
+}
+run seq -j 1
+run jobs -j $JOBS
+diff -r $OUT/seq $OUT/jobs
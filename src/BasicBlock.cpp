@@ -14,9 +14,11 @@
 using namespace std;
 using namespace boost;
 
+/* Creates an empty BB in the derived graph part of parent's arena */
 BB *BB::Create(void */*ctx*/, const string &/*s*/, Function *parent, BB */*insertBefore*/)
 {
-    BB *pnewBB = new BB;
+    assert(parent);
+    BB *pnewBB = parent->m_arena.derivedBlocks.create();
     pnewBB->Parent = parent;
     return pnewBB;
 }
@@ -26,8 +28,12 @@ BB *BB::Create(void */*ctx*/, const string &/*s*/, Function *parent, BB */*inser
 */
 BB *BB::Create(const rCODE &r,eBBKind _nodeType, Function *parent)
 {
-    BB* pnewBB;
-    pnewBB = new BB;
+    return parent->m_arena.cfgBlocks.create()->init(r,_nodeType,parent);
+}
+/* Initialises a freshly allocated BB; parent is null for interval BBs */
+BB *BB::init(const rCODE &r,eBBKind _nodeType, Function *parent)
+{
+    BB* pnewBB = this;
     pnewBB->nodeType = _nodeType;    /* Initialise */
     pnewBB->immedDom = NO_DOM;
     pnewBB->loopHead = pnewBB->caseHead = pnewBB->caseTail =
@@ -55,7 +61,7 @@ BB *BB::Create(const rCODE &r,eBBKind _nodeType, Function *parent)
 BB *BB::CreateIntervalBB(Function *parent)
 {
     iICODE endOfParent = parent->Icode.entries.end();
-    return Create(make_iterator_range(endOfParent,endOfParent),INTERVAL_NODE,nullptr);
+    return parent->m_arena.derivedBlocks.create()->init(make_iterator_range(endOfParent,endOfParent),INTERVAL_NODE,nullptr);
 }
 
 static const char *const s_nodeType[] = {
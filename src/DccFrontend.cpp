@@ -83,7 +83,7 @@ void PROG::displayLoadInfo()
         printf("\nRelocation Table\n");
         for (i = 0; i < cReloc; i++)
         {
-            printf("%06X -> [%04X]\n", relocTable[i],LH(image() + relocTable[i]));
+            printf("%06X -> [%04X]\n", relocTable[i],word(relocTable[i]));
         }
     }
     printf("\n");
@@ -101,7 +101,7 @@ static void fill(int ip, char *bf)
     for (i = 0; i < 16; i++, ip++)
     {
         *bf++ = ' ';
-        *bf++ = (ip < prog.cbImage)? type[(prog.map[ip >> 2] >> ((ip & 3) * 2)) & 3]: ' ';
+        *bf++ = (ip < prog.cbImage)? type[prog.map.at(ip)]: ' ';
     }
     *bf = '\0';
 }
@@ -133,11 +133,9 @@ static void displayMemMap()
             if (not (strcmp(b1, b2) != 0 || strcmp(b1, b3) != 0))
             {
                 printf("                   :\n");
-                do
-                {
-                    ip += 16;
-                    fill(ip+16, b1);
-                } while (0==strcmp(b1, b2));
+                /* Skip to the last line before the one that differs; the
+                 * lines that are all the same lie in a single run */
+                ip += 16 * ((std::min<int>(prog.map.runEnd(ip), prog.cbImage) - ip - 32) / 16 + 1);
             }
         }
     }
@@ -191,15 +189,25 @@ bool DccFrontend::FrontEnd ()
 }
 struct DosLoader {
 protected:
+    /* Maps the load module of sz bytes, starting at the current position of
+     * fp, read-only into the image; the PSP in front of it and the fixups of
+     * relocated segment values are supplied by PROG::byte() */
     void prepareImage(PROG &prog,size_t sz,QFile &fp) {
-        /* Allocate a block of memory for the program. */
         prog.cbImage  = sz + sizeof(PSP);
-        prog.Imagez    = new uint8_t [prog.cbImage];
-        prog.Imagez[0] = 0xCD;		/* Fill in PSP int 20h location */
-        prog.Imagez[1] = 0x20;		/* for termination checking     */
-        /* Read in the image past where a PSP would go */
-        if (sz != fp.read((char *)prog.Imagez + sizeof(PSP),sz))
+        if (fp.pos() + (int64_t)sz > fp.size())
             fatalError(CANNOT_READ, fp.fileName().toLocal8Bit().data());
+        prog.module = sz ? fp.map(fp.pos(),sz) : nullptr;
+        if (prog.module == nullptr)
+        {
+            /* Not mappable, read the module in instead */
+            prog.moduleCopy.resize(sz);
+            if (sz != fp.read((char *)prog.moduleCopy.data(),sz))
+                fatalError(CANNOT_READ, fp.fileName().toLocal8Bit().data());
+            prog.module = prog.moduleCopy.data();
+        }
+        prog.indexRelocations();
+        /* Set up memory map */
+        prog.map.reset(prog.cbImage);
     }
 };
 struct ComLoader : public DosLoader {
@@ -229,12 +237,6 @@ struct ComLoader : public DosLoader {
         prog.cReloc = 0;
 
         prepareImage(prog,cb,fp);
-
-
-        /* Set up memory map */
-        cb = (prog.cbImage + 3) / 4;
-        prog.map = (uint8_t *)malloc(cb);
-        memset(prog.map, BM_UNKNOWN, (size_t)cb);
         return true;
     }
 };
@@ -301,24 +303,11 @@ struct ExeLoader : public DosLoader {
                 prog.relocTable[i] = LH(buf) + (((int)LH(buf+2) + EXE_RELOCATION)<<4);
             }
         }
+        prog.relocBase = EXE_RELOCATION;
         /* Seek to start of image */
         uint32_t start_of_image= LH(&header.numParaHeader) * 16;
         fp.seek(start_of_image);
-        /* Allocate a block of memory for the program. */
         prepareImage(prog,cb,fp);
-
-        /* Set up memory map */
-        cb = (prog.cbImage + 3) / 4;
-        prog.map = (uint8_t *)malloc(cb);
-        memset(prog.map, BM_UNKNOWN, (size_t)cb);
-
-        /* Relocate segment constants */
-        for(uint32_t v : prog.relocTable) {
-            uint8_t *p = &prog.Imagez[v];
-            uint16_t  w = (uint16_t)LH(p) + EXE_RELOCATION;
-            *p++    = (uint8_t)(w & 0x00FF);
-            *p      = (uint8_t)((w & 0xFF00) >> 8);
-        }
         return true;
     }
 };
@@ -330,7 +319,9 @@ bool Project::load()
     // addTask(loaderSelection,PreCond(BinaryImage))
     // addTask(applyLoader,PreCond(Loader))
     const char *fname = binary_path().toLocal8Bit().data();
-    QFile finfo(binary_path());
+    /* Kept open by prog for as long as the image is mapped */
+    prog.file = std::make_shared<QFile>(binary_path());
+    QFile &finfo(*prog.file);
     /* Open the input file */
     if(not finfo.open(QFile::ReadOnly)) {
         fatalError(CANNOT_OPEN, fname);
@@ -376,12 +367,11 @@ void DccFrontend::parse(Project &proj)
     /* Make a struct for the initial procedure */
     if (prog.offMain != -1)
     {
-        start_proc = proj.createFunction(0,"main");
+        /* We know where main() is. Start the flow of control from there */
+        start_proc = proj.createFunction(0,"main",prog.offMain);
         start_proc->retVal.loc = REG_FRAME;
         start_proc->retVal.type = TYPE_WORD_SIGN;
         start_proc->retVal.id.regi = rAX;
-        /* We know where main() is. Start the flow of control from there */
-        start_proc->procEntry = prog.offMain;
         /* In medium and large models, the segment of main may (will?) not be
             the same as the initial CS segment (of the startup code) */
         state.setState(rCS, prog.segMain);
@@ -389,25 +379,36 @@ void DccFrontend::parse(Project &proj)
     }
     else
     {
-        start_proc = proj.createFunction(0,"start");
         /* Create initial procedure at program start address */
-        start_proc->procEntry = (uint32_t)state.IP;
+        start_proc = proj.createFunction(0,"start",(uint32_t)state.IP);
     }
 
     /* The state info is for the first procedure */
     start_proc->state = state;
 
     /* Set up call graph initial node */
-    proj.callGraph = new CALL_GRAPH;
-    proj.callGraph->proc = start_proc;
+    proj.callGraph = new CALL_GRAPH(start_proc);
 
     /* This proc needs to be called to set things up for LibCheck(), which
        checks a proc to see if it is a know C (etc) library */
     prog.bSigs = SetupLibCheck();
     //BUG:  proj and g_proj are 'live' at this point !
 
-    /* Recursively build entire procedure list */
-    start_proc->FollowCtrl(proj.callGraph, &state);
+    /* The decode cache only serves the parser */
+    if (option.PreDecode)
+    {
+        predecode(option.Jobs);
+        /* Match the signatures of all the call targets the sweep found at once */
+        LibCheckBatch(proj.decoded.callTargets());
+    }
+
+    /* Recursively build entire procedure list. Only an explicit -j runs the
+     * search in rounds, see ConcurrentParser for how it differs */
+    if (option.Jobs > 1)
+        start_proc->FollowCtrlConcurrent(&state);
+    else
+        start_proc->FollowCtrl(proj.callGraph, &state);
+    proj.decoded.clear();
 
     /* This proc needs to be called to clean things up from SetupLibCheck() */
     CleanupLibCheck();
@@ -0,0 +1,105 @@
+/*
+ * File:    DecodeCache.cpp
+ * Purpose: instructions of the whole program image, decoded before parsing
+ */
+#include "DecodeCache.h"
+
+#include <algorithm>
+#include <thread>
+
+constexpr uint32_t DecodeCache::MIN_CHUNK;
+
+void DecodeCache::build(uint32_t size, int jobs, Decoder decode)
+{
+    typedef std::vector<std::pair<uint32_t,Entry>> Sweep; /* offset, result */
+    clear();
+    uint32_t chunks = std::max<uint32_t>(1,std::min<uint32_t>(jobs,size/MIN_CHUNK));
+    uint32_t chunkSize = (size+chunks-1)/chunks;
+    std::vector<Sweep> sweeps(chunks);
+    auto sweep = [size,chunkSize,decode,&sweeps](uint32_t chunk)
+    {
+        uint32_t end = std::min(size,(chunk+1)*chunkSize);
+        ICODE ic;
+        for (uint32_t ip = chunk*chunkSize; ip < end; )
+        {
+            eErrorId err = decode(ip, ic);
+            sweeps[chunk].emplace_back(ip,Entry{*ic.ll(),err});
+            /* Invalid opcodes have no length, the sweep goes on with the next byte */
+            ip += std::max<uint32_t>(1,(err==INVALID_OPCODE or err==INVALID_386OP) ? 0 : ic.ll()->numBytes);
+        }
+    };
+    std::vector<std::thread> threads;
+    for (uint32_t chunk = 1; chunk < chunks; ++chunk)
+        threads.emplace_back(sweep,chunk);
+    sweep(0);
+    for (std::thread &t : threads)
+        t.join();
+
+    m_index.assign(size,0);
+    for (Sweep &s : sweeps)
+    {
+        for (std::pair<uint32_t,Entry> &decoded : s)
+        {
+            m_entries.push_back(std::move(decoded.second));
+            m_index[decoded.first] = m_entries.size();
+            m_maxBytes = std::max<uint32_t>(m_maxBytes,m_entries.back().inst.numBytes);
+        }
+        Sweep().swap(s);
+    }
+    m_live = m_entries.size();
+}
+
+bool DecodeCache::lookup(uint32_t ip, ICODE &p, eErrorId &err) const
+{
+    if ((ip >= m_index.size()) or (m_index[ip] == 0))
+        return false;
+    const Entry &e(m_entries[m_index[ip]-1]);
+    p = ICODE();
+    p.type = LOW_LEVEL_ICODE;
+    *p.ll() = e.inst;
+    err = e.err;
+    return true;
+}
+
+void DecodeCache::invalidate(uint32_t start, uint32_t len)
+{
+    if (start >= m_index.size())
+        return;
+    uint32_t end = std::min<uint32_t>(m_index.size(),start+len);
+    /* Instructions starting before start may reach into the range */
+    for (uint32_t ip = (start >= m_maxBytes) ? start-m_maxBytes+1 : 0; ip < end; ++ip)
+    {
+        if (m_index[ip] == 0)
+            continue;
+        uint32_t numBytes = std::max<uint32_t>(1,m_entries[m_index[ip]-1].inst.numBytes);
+        if (ip+numBytes > start)
+        {
+            m_index[ip] = 0;
+            --m_live;
+        }
+    }
+}
+
+void DecodeCache::clear()
+{
+    std::vector<uint32_t>().swap(m_index);
+    std::vector<Entry>().swap(m_entries);
+    m_live = 0;
+    m_maxBytes = 1;
+}
+
+std::vector<uint32_t> DecodeCache::callTargets() const
+{
+    std::vector<uint32_t> res;
+    for (uint32_t idx : m_index)
+    {
+        if (idx == 0)
+            continue;
+        const Entry &e(m_entries[idx-1]);
+        if ((e.err == NO_ERR) and ((e.inst.getOpcode() == iCALL) or (e.inst.getOpcode() == iCALLF)) and e.inst.testFlags(I))
+            res.push_back(e.inst.src().getImm2());
+    }
+    std::sort(res.begin(),res.end());
+    res.erase(std::unique(res.begin(),res.end()),res.end());
+    return res;
+}
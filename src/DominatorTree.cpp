@@ -0,0 +1,127 @@
+/*
+ * File:    DominatorTree.cpp
+ * Purpose: iterative dominator computation over dfsLast numbered CFGs
+ */
+#include "DominatorTree.h"
+
+#include <cassert>
+
+constexpr int DominatorTree::UNDEFINED;
+
+/* Walks both nodes up the tree until they meet; smaller dfsLast indexes are
+ * closer to the root, so the node with the larger index moves up. */
+int DominatorTree::intersect(int a, int b) const
+{
+    while (a != b)
+    {
+        while (a > b)
+            a = m_idom[a];
+        while (b > a)
+            b = m_idom[b];
+    }
+    return a;
+}
+
+void DominatorTree::build(int root, const std::vector<int> &predStart, const std::vector<int> &preds)
+{
+    size_t numNodes = predStart.size()-1;
+    assert(predStart.size()>0 and size_t(root)<numNodes);
+    m_idom.assign(numNodes,UNDEFINED);
+    m_idom[root] = root;
+
+    /* Nodes are visited in dfsLast (reverse postorder) order, so on a
+     * reducible graph the second pass only confirms the first one. */
+    bool changed = true;
+    m_passes = 0;
+    while (changed)
+    {
+        changed = false;
+        ++m_passes;
+        for (size_t node = 0; node < numNodes; node++)
+        {
+            if (int(node) == root)
+                continue;
+            int newIdom = UNDEFINED;
+            for (int idx = predStart[node]; idx < predStart[node+1]; idx++)
+            {
+                int pred = preds[idx];
+                if (m_idom[pred] == UNDEFINED)
+                    continue;
+                newIdom = (newIdom == UNDEFINED) ? pred : intersect(pred, newIdom);
+            }
+            if (newIdom != m_idom[node])
+            {
+                m_idom[node] = newIdom;
+                changed = true;
+            }
+        }
+    }
+
+    /* Children lists in compressed form, ascending by construction */
+    m_childStart.assign(numNodes+1,0);
+    for (size_t node = 0; node < numNodes; node++)
+        if ((int(node) != root) and (m_idom[node] != UNDEFINED))
+            m_childStart[m_idom[node]+1]++;
+    for (size_t node = 0; node < numNodes; node++)
+        m_childStart[node+1] += m_childStart[node];
+    m_childList.resize(m_childStart[numNodes]);
+    std::vector<int> fill(m_childStart.begin(),m_childStart.end()-1);
+    for (size_t node = 0; node < numNodes; node++)
+        if ((int(node) != root) and (m_idom[node] != UNDEFINED))
+            m_childList[fill[m_idom[node]]++] = node;
+
+    numberTree(root);
+}
+
+/* Pre and post order numbering of the dominator tree, without recursion:
+ * functions with thousands of nested blocks would overflow the stack. */
+void DominatorTree::numberTree(int root)
+{
+    m_pre.assign(m_idom.size(),UNDEFINED);
+    m_post.assign(m_idom.size(),UNDEFINED);
+    std::vector<std::pair<int,int>> stack; /* node, next child position */
+    int preNum = 0, postNum = 0;
+    m_pre[root] = preNum++;
+    stack.emplace_back(root,m_childStart[root]);
+    while (not stack.empty())
+    {
+        std::pair<int,int> &top(stack.back());
+        if (top.second == m_childStart[top.first+1])
+        {
+            m_post[top.first] = postNum++;
+            stack.pop_back();
+            continue;
+        }
+        int child = m_childList[top.second++];
+        m_pre[child] = preNum++;
+        stack.emplace_back(child,m_childStart[child]);
+    }
+}
+
+void DominatorTree::clear()
+{
+    m_idom.clear();
+    m_childStart.clear();
+    m_childList.clear();
+    m_pre.clear();
+    m_post.clear();
+    m_passes = 0;
+}
+
+int DominatorTree::immedDom(int node) const
+{
+    int res = m_idom[node];
+    return (res == node) ? UNDEFINED : res;
+}
+
+DominatorTree::NodeRange DominatorTree::children(int node) const
+{
+    return NodeRange(m_childList.begin()+m_childStart[node],m_childList.begin()+m_childStart[node+1]);
+}
+
+bool DominatorTree::dominates(int a, int b) const
+{
+    if (not reachable(a) or not reachable(b))
+        return false;
+    return (m_pre[a] <= m_pre[b]) and (m_post[b] <= m_post[a]);
+}
@@ -0,0 +1,143 @@
+/*
+ * File:    ExprArena.cpp
+ * Purpose: per procedure storage for expression trees (Expr nodes)
+ */
+#include "ExprArena.h"
+
+#include "ast.h"
+
+#include <algorithm>
+#include <cassert>
+#include <new>
+
+namespace
+{
+/* Placed in front of every node, keeps the node itself GRANULE aligned */
+struct alignas(16) NodeHeader
+{
+    ExprArena * owner;      /* nullptr for nodes allocated on the heap */
+    bool        shared;
+};
+static_assert(sizeof(NodeHeader)==16,"Expr nodes would lose their alignment");
+
+thread_local ExprArena *s_current = nullptr;
+
+NodeHeader *headerOf(const void *node)
+{
+    return reinterpret_cast<NodeHeader *>(const_cast<char *>(static_cast<const char *>(node))-sizeof(NodeHeader));
+}
+}
+
+constexpr size_t ExprArena::GRANULE;
+constexpr size_t ExprArena::MAX_NODE;
+constexpr size_t ExprArena::FIRST_CHUNK;
+constexpr size_t ExprArena::MAX_CHUNK;
+
+ExprArena::Scope::Scope(ExprArena &arena) : m_prev(s_current)
+{
+    s_current = &arena;
+}
+ExprArena::Scope::~Scope()
+{
+    s_current = m_prev;
+}
+ExprArena *ExprArena::current()
+{
+    return s_current;
+}
+
+void *ExprArena::allocateNode(size_t size)
+{
+    size_t blockSize = (sizeof(NodeHeader)+size+GRANULE-1) & ~(GRANULE-1);
+    NodeHeader *hdr;
+    if ((s_current != nullptr) and (blockSize <= MAX_NODE))
+    {
+        hdr = static_cast<NodeHeader *>(s_current->allocate(blockSize));
+        hdr->owner = s_current;
+    }
+    else
+    {
+        hdr = static_cast<NodeHeader *>(::operator new(blockSize));
+        hdr->owner = nullptr;
+    }
+    hdr->shared = false;
+    return hdr+1;
+}
+
+void ExprArena::freeNode(void *ptr, size_t size)
+{
+    if (ptr == nullptr)
+        return;
+    NodeHeader *hdr = headerOf(ptr);
+    assert(not hdr->shared);    /* shared nodes go through Expr::destroy */
+    if (hdr->owner == nullptr)
+    {
+        ::operator delete(hdr);
+        return;
+    }
+    size_t blockSize = (sizeof(NodeHeader)+size+GRANULE-1) & ~(GRANULE-1);
+    hdr->owner->recycle(hdr,blockSize);
+}
+
+bool ExprArena::isShared(const Expr *e)
+{
+    return headerOf(e)->shared;
+}
+
+void *ExprArena::allocate(size_t size)
+{
+    ++m_live;
+    FreeBlock *&head(m_free[size/GRANULE]);
+    if (head != nullptr)
+    {
+        void *res = head;
+        head = head->next;
+        return res;
+    }
+    if (m_left < size)
+    {
+        /* Chunks double in size, so that arenas of small procedures stay small */
+        size_t chunkSize = std::min(FIRST_CHUNK<<std::min<size_t>(m_chunks.size(),8),MAX_CHUNK);
+        m_top = static_cast<char *>(::operator new(chunkSize));
+        m_left = chunkSize;
+        m_chunks.push_back(m_top);
+    }
+    void *res = m_top;
+    m_top += size;
+    m_left -= size;
+    return res;
+}
+
+void ExprArena::recycle(void *block, size_t size)
+{
+    --m_live;
+    FreeBlock *blk = static_cast<FreeBlock *>(block);
+    blk->next = m_free[size/GRANULE];
+    m_free[size/GRANULE] = blk;
+}
+
+Constant *ExprArena::constant(uint32_t value, uint8_t size)
+{
+    Constant *&res(m_constants[(uint64_t(value)<<8)|size]);
+    if (res == nullptr)
+    {
+        Scope scope(*this);
+        res = new Constant(value,size);
+        headerOf(res)->shared = true;
+    }
+    return res;
+}
+
+void ExprArena::release()
+{
+    /* Expr nodes hold nothing but plain values and pointers to other nodes,
+     * so their destructors can be skipped */
+    for (char *chunk : m_chunks)
+        ::operator delete(chunk);
+    m_chunks.clear();
+    std::fill(std::begin(m_free),std::end(m_free),nullptr);
+    m_constants.clear();
+    m_top = nullptr;
+    m_left = 0;
+    m_live = 0;
+}
@@ -0,0 +1,99 @@
+/*
+ * File:    MemoryMap.cpp
+ * Purpose: what the bytes of the program image have been found to be
+ */
+#include "MemoryMap.h"
+
+#include <iterator>
+
+void MemoryMap::reset(uint32_t size)
+{
+    m_runs.clear();
+    m_size = size;
+    if (size)
+        m_runs.emplace(0,0);
+}
+
+/* Returns the run holding off, which must be inside the map */
+MemoryMap::Runs::const_iterator MemoryMap::find(uint32_t off) const
+{
+    return std::prev(m_runs.upper_bound(off));
+}
+
+/* Makes pos the start of a run and returns it; end() if pos is the end of
+ * the map */
+MemoryMap::Runs::iterator MemoryMap::split(uint32_t pos)
+{
+    if (pos >= m_size)
+        return m_runs.end();
+    Runs::iterator it = std::prev(m_runs.upper_bound(pos));
+    if (it->first == pos)
+        return it;
+    return m_runs.emplace_hint(std::next(it),pos,it->second);
+}
+
+void MemoryMap::set(uint32_t start, uint32_t len, uint8_t type)
+{
+    if (start >= m_size or len == 0 or type == 0)
+        return;
+    uint32_t end = (len > m_size-start) ? m_size : start+len;
+    /* Most calls add code bits to code that is already known */
+    Runs::const_iterator holder = find(start);
+    if (((holder->second & type) == type) and runEnd(start) >= end)
+        return;
+    Runs::iterator first = split(start);
+    Runs::iterator last = split(end);
+    for (Runs::iterator it = first; it != last; ++it)
+        it->second |= type;
+    /* Join the runs from the one before start up to the one at end that
+     * now have the same bits */
+    Runs::iterator it = (first == m_runs.begin()) ? first : std::prev(first);
+    for (Runs::iterator next = std::next(it); next != m_runs.end() and next->first <= end; next = std::next(it))
+    {
+        if (next->second == it->second)
+            m_runs.erase(next);
+        else
+            it = next;
+    }
+}
+
+uint8_t MemoryMap::at(uint32_t off) const
+{
+    if (off >= m_size)
+        return 0;
+    return find(off)->second;
+}
+
+uint32_t MemoryMap::runEnd(uint32_t off) const
+{
+    if (off >= m_size)
+        return m_size;
+    Runs::const_iterator next = m_runs.upper_bound(off);
+    return (next == m_runs.end()) ? m_size : next->first;
+}
+
+bool MemoryMap::any(uint32_t start, uint32_t len, uint8_t type) const
+{
+    if (start >= m_size or len == 0)
+        return false;
+    uint32_t end = (len > m_size-start) ? m_size : start+len;
+    for (Runs::const_iterator it = find(start); it != m_runs.end() and it->first < end; ++it)
+    {
+        if (it->second & type)
+            return true;
+    }
+    return false;
+}
+
+std::vector<MemoryMap::Region> MemoryMap::regions(uint8_t type) const
+{
+    std::vector<Region> res;
+    for (Runs::const_iterator it = m_runs.begin(); it != m_runs.end(); ++it)
+    {
+        if ((type == 0) ? (it->second != 0) : ((it->second & type) == 0))
+            continue;
+        Runs::const_iterator next = std::next(it);
+        res.push_back(Region{it->first, (next == m_runs.end()) ? m_size : next->first, it->second});
+    }
+    return res;
+}
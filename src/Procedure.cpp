@@ -17,7 +17,7 @@ void JumpTable::pruneEntries(uint16_t cs)
     PROG *prg(Project::get()->binary());
     for (uint32_t i = start; i < finish; i += 2)
     {
-        uint32_t target = cs + LH(&prg->image()[i]);
+        uint32_t target = cs + prg->word(i);
         if (target < finish and target >= start)
             finish = target;
         else if (target >= (uint32_t)prg->cbImage)
@@ -26,9 +26,9 @@ void JumpTable::pruneEntries(uint16_t cs)
     ICODE _Icode; // used as scan input
     for (uint32_t i = start; i < finish; i += 2)
     {
-        uint32_t target = cs + LH(&prg->image()[i]);
+        uint32_t target = cs + prg->word(i);
         /* Be wary of 00 00 as code - it's probably data */
-        if (not (prg->image()[target] or prg->image()[target+1]) or scan(target, _Icode))
+        if (not (prg->byte(target) or prg->byte(target+1)) or scan(target, _Icode))
             finish = i;
     }
 
@@ -38,3 +38,49 @@ void JumpTable::pruneEntries(uint16_t cs)
 void Function::callingConv(CConv::Type v) {
     m_call_conv=CConv::create(v);
 }
+
+/* Records the parameter size and calling convention of target, found by the
+ * idioms of this procedure. */
+void Function::setCallInfo(Function *target, int16_t cbParam, CConv::Type conv)
+{
+    if (m_deferred)
+    {
+        m_deferred->callInfo.push_back(DeferredUpdates::CallInfo{target,cbParam,conv});
+        return;
+    }
+    target->cbParam = cbParam;
+    target->callingConv(conv);
+}
+
+/* Makes delta, the bytes of parameters found in the stack frame, the
+ * parameter size of this procedure. A size other than the one the idioms
+ * found leaves the calling convention unknown. */
+void Function::checkParamBytes(int16_t delta)
+{
+    if (m_deferred)
+    {
+        m_deferred->checkParams = true;
+        m_deferred->paramBytes = delta;
+        return;
+    }
+    if (cbParam != delta)
+    {
+        cbParam = delta;
+        callingConv(CConv::eUnknown);
+    }
+}
+
+/* Applies what buildCFG deferred while running on a worker thread */
+void Function::applyDeferredUpdates()
+{
+    DeferredUpdates *upd = m_deferred;
+    m_deferred = nullptr;
+    upd->log.replay();
+    for (const DeferredUpdates::CallInfo &info : upd->callInfo)
+        setCallInfo(info.proc, info.cbParam, info.conv);
+    if (upd->checkParams)
+        checkParamBytes(upd->paramBytes);
+    for (iICODE picode : upd->calls)
+        picode->hlU()->call.args->cb = picode->ll()->src().proc.proc->cbParam;
+    delete upd;
+}
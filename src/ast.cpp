@@ -28,7 +28,7 @@ using namespace std;
 using namespace boost;
 using namespace boost::adaptors;
 
-extern int     strSize (const uint8_t *, char);
+extern int     strSize (uint32_t, char);
 extern char   *cChar(uint8_t c);
 namespace
 {
@@ -61,7 +61,7 @@ void ICODE::setRegDU (eReg regi, operDu du_in)
     //    printf("%s %d %x\n",__FUNCTION__,regi,int(du_in));
     if(regi==rSP)
     {
-        printf("Discarding SP def&use info for now\n");
+        dccPrintf("Discarding SP def&use info for now\n");
         return;
     }
     switch (du_in)
@@ -131,7 +131,7 @@ GlobalVariable::GlobalVariable(int16_t segValue, int16_t off)
     auto i=Project::get()->getSymIdxByAddr(adr);
     if ( not Project::get()->validSymIdx(i) )
     {
-        printf ("Error, glob var not found in symtab\n");
+        dccPrintf("Error, glob var not found in symtab\n");
         valid = false;
     }
     globIdx = i;
@@ -157,7 +157,7 @@ AstIdent *AstIdent::Loc(int off, LOCAL_ID *localId)
             break;
     }
     if (i == localId->csym())
-        printf ("Error, cannot find local var\n");
+        dccPrintf("Error, cannot find local var\n");
     newExp->ident.idNode.localIdx = i;
     localId->id_arr[i].setLocalName(i);
     return (newExp);
@@ -172,7 +172,7 @@ AstIdent *AstIdent::Param(int off, const STKFRAME * argSymtab)
     newExp->ident.idType = PARAM;
     auto iter=argSymtab->findByLabel(off);
     if (iter == argSymtab->end())
-        printf ("Error, cannot find argument var\n");
+        dccPrintf("Error, cannot find argument var\n");
     newExp->ident.idNode.localIdx = std::distance(argSymtab->begin(),iter);
     return newExp;
 }
@@ -191,7 +191,7 @@ GlobalVariableIdx::GlobalVariableIdx (int16_t segValue, int16_t off, uint8_t reg
             break;
     }
     if (i == locSym->csym())
-        printf ("Error, indexed-glob var not found in local id table\n");
+        dccPrintf("Error, indexed-glob var not found in local id table\n");
     idxGlbIdx = i;
 }
 QString GlobalVariableIdx::walkCondExpr(Function *pProc, int *) const
@@ -232,7 +232,7 @@ AstIdent *AstIdent::Long(LOCAL_ID *localId, opLoc sd, iICODE pIcode, hlFirst f,
             value = (pIcode->ll()->src().getImm2() << 16) + atOffset.src().getImm2();
         else/* LOW_FIRST */
             value = (atOffset.src().getImm2() << 16)+ pIcode->ll()->src().getImm2();
-        newExp = new Constant(value,4);
+        newExp = Constant::Create(value,4);
     }
     /* Save it as a long expression (reg, stack or glob) */
     else
@@ -281,7 +281,7 @@ AstIdent *AstIdent::idID (const ID *retVal, LOCAL_ID *locsym, iICODE ix_)
             newExp = new RegisterNode(locsym->newByteWordReg(retVal->type, retVal->id.regi),BYTE_REG,locsym);
             break;
         default:
-            fprintf(stderr,"AstIdent::idID unhandled type %d\n",retVal->type);
+            dccFprintf(stderr,"AstIdent::idID unhandled type %d\n",retVal->type);
     }
     return (newExp);
 }
@@ -317,7 +317,7 @@ Expr *AstIdent::id(const LLInst &ll_insn, opLoc sd, Function * pProc, iICODE ix_
     }
     
     else if ((sd == SRC) and ll_insn.testFlags(I)) /* constant */
-        newExp = new Constant(ll_insn.src().getImm2(), 2);
+        newExp = Constant::Create(ll_insn.src().getImm2(), 2);
     else if (pm.regi == rUNDEF) /* global variable */
         newExp = new GlobalVariable(pm.segValue, pm.off);
     else if ( pm.isReg() )      /* register */
@@ -402,7 +402,7 @@ int Expr::hlTypeSize(Function * pproc) const
 {
     if (this == nullptr)
         return 2;		/* for TYPE_UNKNOWN */
-    fprintf(stderr,"hlTypeSize queried for Unkown type %d \n",m_type);
+    dccFprintf(stderr,"hlTypeSize queried for Unkown type %d \n",m_type);
     return 2;			// CC: is this correct?
 }
 
@@ -516,7 +516,7 @@ Expr * HlTypeSupport::performLongRemoval (eReg regi, LOCAL_ID *locId, Expr *tree
             return tree->performLongRemoval(regi,locId);
             break;
         default:
-            fprintf(stderr,"performLongRemoval attemped on %d\n",tree->m_type);
+            dccFprintf(stderr,"performLongRemoval attemped on %d\n",tree->m_type);
             break;
     }
     return tree;
@@ -529,10 +529,10 @@ static QString getString (int offset)
     QString o;
     int strLen, i;
     
-    strLen = strSize (&prog.image()[offset], '\0');
+    strLen = strSize (offset, '\0');
     o += '"';
     for (i = 0; i < strLen; i++)
-        o += cChar(prog.image()[offset+i]);
+        o += cChar(prog.byte(offset+i));
     o += "\"\0";
     return o;
 }
@@ -718,7 +718,7 @@ Expr *UnaryOperator::insertSubTreeReg(Expr *_expr, eReg regi, const LOCAL_ID *lo
             }
             return nullptr;
         default:
-            fprintf(stderr,"insertSubTreeReg attempt on unhandled type %d\n",m_type);
+            dccFprintf(stderr,"insertSubTreeReg attempt on unhandled type %d\n",m_type);
     }
     return nullptr;
 }
@@ -838,7 +838,7 @@ Expr *BinaryOperator::inverse() const
             res->m_rhs=m_rhs->inverse ();
             return res;
         default:
-            fprintf(stderr,"BinaryOperator::inverse attempt on unhandled op %d\n",m_op);
+            dccFprintf(stderr,"BinaryOperator::inverse attempt on unhandled op %d\n",m_op);
     } /* eos */
     assert(false);
     return res;
@@ -50,6 +50,9 @@ void Function::displayStats ()
         qDebug() << QString("  Percentage reduction: %1%%").arg(100.0 - (stats.numHLIcode *
                                                               100.0) / stats.numLLIcode,4,'f',2,QChar('0'));
     }
+    if (liveAnal)
+        qDebug() << "Live register analysis:" << liveStats.blockVisits << "block visits in"
+                 << liveStats.passes << "passes";
 }
 
 
@@ -115,23 +118,23 @@ static void printGlobVar (QTextStream &ostr,SYM * psym)
     switch (psym->size)
     {
         case 1:
-            ostr << "uint8_t\t"<<psym->name<<" = "<<prog.image()[relocOp]<<";\n";
+            ostr << "uint8_t\t"<<psym->name<<" = "<<prog.byte(relocOp)<<";\n";
             break;
         case 2:
-            ostr << "uint16_t\t"<<psym->name<<" = "<<LH(prog.image()+relocOp)<<";\n";
+            ostr << "uint16_t\t"<<psym->name<<" = "<<prog.word(relocOp)<<";\n";
             break;
         case 4: if (psym->type == TYPE_PTR)  /* pointer */
-                ostr << "uint16_t *\t"<<psym->name<<" = "<<LH(prog.image()+relocOp)<<";\n";
+                ostr << "uint16_t *\t"<<psym->name<<" = "<<prog.word(relocOp)<<";\n";
             else             /* char */
                 ostr << "char\t"<<psym->name<<"[4] = \""<<
-                        prog.image()[relocOp]<<prog.image()[relocOp+1]<<
-                        prog.image()[relocOp+2]<<prog.image()[relocOp+3]<<";\n";
+                        prog.byte(relocOp)<<prog.byte(relocOp+1)<<
+                        prog.byte(relocOp+2)<<prog.byte(relocOp+3)<<";\n";
             break;
         default:
         {
             QString strContents;
             for (j=0; j < psym->size; j++)
-                strContents += cChar(prog.image()[relocOp + j]);
+                strContents += cChar(prog.byte(relocOp + j));
             ostr << "char\t*"<<psym->name<<" = \""<<strContents<<"\";\n";
         }
     }
@@ -217,6 +220,7 @@ static void emitFwdGotoLabel (ICODE * pt, int indLevel)
 void Function::codeGen (QIODevice &fs)
 {
     using namespace boost::adaptors;
+    ExprArena::Scope exprScope(m_exprs);
 
     int numLoc;
     QString ostr_contents;
@@ -324,32 +328,34 @@ void Function::codeGen (QIODevice &fs)
 
 /* Recursive procedure. Displays the procedure's code in depth-first order
  * of the call graph.    */
-static void backBackEnd (CALL_GRAPH * pcallGraph, QIODevice &_ios)
+static void backBackEnd (const CALL_GRAPH &callGraph, int nodeIdx, QIODevice &_ios)
 {
 
     //    IFace.Yield();            /* This is a good place to yield to other apps */
+    Function &proc(*callGraph.node(nodeIdx).proc);
 
     /* Check if this procedure has been processed already */
-    if ((pcallGraph->proc->flg & PROC_OUTPUT) or
-        (pcallGraph->proc->flg & PROC_ISLIB))
+    if ((proc.flg & PROC_OUTPUT) or
+        (proc.flg & PROC_ISLIB))
         return;
-    pcallGraph->proc->flg |= PROC_OUTPUT;
+    proc.flg |= PROC_OUTPUT;
 
     /* Dfs if this procedure has any successors */
-    for (auto & elem : pcallGraph->outEdges)
+    for (int callee : callGraph.node(nodeIdx).outEdges)
     {
-        backBackEnd (elem, _ios);
+        backBackEnd (callGraph, callee, _ios);
     }
 
     /* Generate code for this procedure */
-    stats.numLLIcode = pcallGraph->proc->Icode.entries.size();
+    stats.numLLIcode = proc.Icode.entries.size();
     stats.numHLIcode = 0;
-    pcallGraph->proc->codeGen (_ios);
+    proc.codeGen (_ios);
+    proc.m_exprs.release();     /* nothing reads the expressions after this */
 
     /* Generate statistics */
     if (option.Stats)
-        pcallGraph->proc->displayStats ();
-    if (not (pcallGraph->proc->flg & PROC_ASM))
+        proc.displayStats ();
+    if (not (proc.flg & PROC_ASM))
     {
         stats.totalLL += stats.numLLIcode;
         stats.totalHL += stats.numHLIcode;
@@ -377,7 +383,7 @@ void BackEnd(CALL_GRAPH * pcallGraph)
     stats.totalHL = 0;
 
     /* Process each procedure at a time */
-    backBackEnd (pcallGraph, fs);
+    backBackEnd (*pcallGraph, pcallGraph->root(), fs);
 
     /* Close output file */
     fs.close();
@@ -9,25 +9,29 @@
 #include "msvc_fixes.h"
 #include "project.h"
 #include "perfhlib.h"
+#include "SigPack.h"
 #include "dcc_interface.h"
 
 #include <QtCore/QDir>
+#include <QtCore/QFile>
 #include <QtCore/QString>
 #include <QtCore/QDebug>
 #include <stdio.h>
 #include <stdlib.h>
 #include <memory.h>
 #include <string.h>
+#include <unordered_map>
+#include <vector>
 
-PerfectHash g_pattern_hasher;
 #define  NIL   -1                   /* Used like NULL, but 0 is valid */
 
-/* Hash table structure */
+/* Hash table structure, as stored in the signature file */
 struct HT
 {
     char    htSym[SYMLEN];
     uint8_t    htPat[PATLEN];
 };
+static_assert(sizeof(HT) == SYMLEN + PATLEN, "HT entries are used in place");
 
 /* Structure of the prototypes table. Same as the struct in parsehdr.h,
     except here we don't need the "next" index (the elements are already
@@ -44,38 +48,79 @@ struct PH_FUNC_STRUCT
 
 #define NUM_PLIST   64              	/* Number of entries to increase allocation by */
 
+/* A signature file, on its own or as a section of a signature pack, set up
+    for hashing */
+struct SigTable
+{
+    QString     name;                   /* Signature file name, for messages */
+    PerfectHash hasher;                 /* Hashes patterns with its T1, T2 and g */
+    const HT *  ht;                     /* The hash table, in the signature file */
+};
+
+/* A file mapped while it is in use, or read in if it cannot be mapped */
+struct MappedFile
+{
+    QFile           file;
+    const uint8_t * mapped=nullptr;
+    std::vector<uint8_t> copy;
+    size_t          size=0;
+    const uint8_t * data() const { return mapped ? mapped : copy.data(); }
+    /* Returns false if the file cannot be opened or read */
+    bool load(const QString &path)
+    {
+        file.setFileName(path);
+        if (not file.open(QFile::ReadOnly))
+            return false;
+        size = file.size();
+        mapped = (size != 0) ? file.map(0, size) : nullptr;
+        if (mapped)
+            return true;
+        copy.resize(size);
+        if (size != (size_t)file.read((char *)copy.data(), size))
+        {
+            printf("Could not read %s\n", qPrintable(path));
+            return false;
+        }
+        return true;
+    }
+    void close()
+    {
+        if (mapped)
+            file.unmap((uint8_t *)mapped);
+        mapped = nullptr;
+        std::vector<uint8_t>().swap(copy);
+        size = 0;
+        file.close();
+    }
+};
+
 /* statics */
-static char buf[100];          				/* A general purpose buffer */
-int numKeys;            				/* Number of hash table entries (keys) */
-int numVert;            				/* Number of vertices in the graph (also size of g[]) */
-unsigned PatLen;        				/* Size of the keys (pattern length) */
-unsigned SymLen;        				/* Max size of the symbols, including null */
-static FILE *g_file;                				/* File being read */
+static MappedFile g_sigFile;                    /* Signature file or pack, while in use */
+static std::vector<SigTable> g_sigTables;       /* Signatures LibCheck tries, in order */
+static std::unordered_map<uint32_t,const HT *> g_libMatches;   /* Found by LibCheckBatch, nullptr if none */
 static QString sSigName; 			/* Full path name of .sig file */
 
-static  uint16_t    *T1base, *T2base;       /* Pointers to start of T1, T2 */
-static  uint16_t    *g;                     /* g[] */
-static  HT      *ht;                    /* The hash table */
 static  PH_FUNC_STRUCT *pFunc;          /* Points to the array of func names */
 static  hlType  *pArg=nullptr;                /* Points to the array of param types */
 static  int     numFunc;                /* Number of func names actually stored */
 static  int     numArg;                 /* Number of param names actually stored */
 #define DCCLIBS "dcclibs.dat"           /* Name of the prototypes data file */
+#define SIGPACK "dccsigs.pak"           /* Name of the signature pack, see SigPack.h */
 
 /* prototypes */
-void grab(int n, FILE *_file);
-uint16_t readFileShort(FILE *_file);
-void readFileSection(uint16_t* p, int len, FILE *_file);
+void readFileSection(uint16_t* p, const uint16_t *src, int len);
 void cleanup();
 void checkStartup(STATE *state);
 void readProtoFile();
-int  searchPList(char *name);
+void readProtos(const uint8_t *data, size_t size, const QString &name);
+int  searchPList(const char *name);
 void checkHeap(char *msg);              /* For debugging */
 
 void fixWildCards(uint8_t pat[]);			/* In fixwild.c */
 
-static bool locatePattern(const uint8_t *source, int iMin, int iMax, uint8_t *pattern,
+static bool locatePattern(const PROG &source, int iMin, int iMax, uint8_t *pattern,
                            int iPatLen, int *index);
+static bool matchPattern(const PROG &source, int off, const uint8_t *pattern, int iPatLen);
 
 /*  *   *   *   *   *   *   *   *   *   *   *   *   *   *   *\
 *                                                            *
@@ -295,141 +340,296 @@ static uint8_t pattMsChkstk[] =
 
 
 
-/* This procedure is called to initialise the library check code */
-bool SetupLibCheck(void)
+/* Reads the sections of a signature or prototypes file held in memory. The
+ * callers check the layout against the file size before reading it. */
+struct SigReader
 {
-    uint16_t w, len;
-    int i;
-    IDcc *dcc = IDcc::get();
-    QString fpath = dcc->dataDir("sigs").absoluteFilePath(sSigName);
-    if ((g_file = fopen(qPrintable(fpath), "rb")) == nullptr)
+    const uint8_t * pos;
+    const uint8_t * end;
+    uint16_t readShort()
     {
-        printf("Warning: cannot open signature file %s\n", qPrintable(fpath));
-        return false;
+        uint16_t w = (uint16_t)(pos[1] << 8) + (uint16_t)pos[0];
+        pos += 2;
+        return w;
+    }
+    /* Steps over the two character name of a section */
+    bool section(const char *name)
+    {
+        bool res = memcmp(name, pos, 2) == 0;
+        pos += 2;
+        return res;
+    }
+    /* Returns the start of a table of len bytes and steps over it */
+    const uint16_t *table(size_t len)
+    {
+        const uint16_t *res = (const uint16_t *)pos;
+        pos += len;
+        return res;
     }
+};
 
-    readProtoFile();
+/* The tables of a signature file are used where the file is mapped, unless
+ * its little endian shorts have to be converted first */
+static bool tablesUsableInPlace()
+{
+    const uint16_t probe = 1;
+    return *(const uint8_t *)&probe == 1;
+}
 
+/* Sets up table to hash with the signature file held in data. The layout
+ * is checked against size before any section is used. */
+static bool loadSigTable(const QString &name, const uint8_t *data, size_t size, SigTable &table)
+{
+    uint16_t w, len;
+    SigReader sig {data, data + size};
 
     /* Read the parameters */
-    grab(4, g_file);
-    if (memcmp("dccs", buf, 4) != 0)
+    if ((size < 12) or (memcmp("dccs", sig.pos, 4) != 0))
     {
         printf("Not a dcc signature file!\n");
         exit(3);
     }
-    numKeys = readFileShort(g_file);
-    numVert = readFileShort(g_file);
-    PatLen = readFileShort(g_file);
-    SymLen = readFileShort(g_file);
+    sig.pos += 4;
+    int numKeys = sig.readShort();          /* Number of hash table entries (keys) */
+    int numVert = sig.readShort();          /* Number of vertices in the graph (also size of g[]) */
+    unsigned PatLen = sig.readShort();      /* Size of the keys (pattern length) */
+    unsigned SymLen = sig.readShort();      /* Max size of the symbols, including null */
     if ((PatLen != PATLEN) or (SymLen != SYMLEN))
     {
         printf("Sorry! Compiled for sym and pattern lengths of %d and %d\n", SYMLEN, PATLEN);
         return false;
     }
+    /* All sections have a name and a byte length in front */
+    size_t tableLen = PatLen * 256 * sizeof(uint16_t);
+    size_t gLen = numVert * sizeof(uint16_t);
+    size_t htLen = numKeys * sizeof(HT);
+    if ((size_t)(sig.end - sig.pos) < 4 + tableLen + 4 + tableLen + 4 + gLen + 4 + htLen)
+    {
+        printf("Signature file %s is truncated\n", qPrintable(name));
+        return false;
+    }
 
-    /* Initialise the perfhlib stuff. Also allocates T1, T2, g, etc */
-    /* Set the parameters for the hash table */
-    g_pattern_hasher.setHashParams(
-                    numKeys,                /* The number of symbols */
-                    PatLen,                 /* The length of the pattern to be hashed */
-                    256,                    /* The character set of the pattern (0-FF) */
-                    0,                      /* Minimum pattern character value */
-                    numVert);               /* Specifies c, the sparseness of the graph. See Czech, Havas and Majewski for details */
-    T1base  = g_pattern_hasher.readT1();
-    T2base  = g_pattern_hasher.readT2();
-    g       = g_pattern_hasher.readG();
-
-    /* Read T1 and T2 tables */
-    grab(2, g_file);
-    if (memcmp("T1", buf, 2) != 0)
+    /* T1 and T2 tables */
+    if (not sig.section("T1"))
     {
         printf("Expected 'T1'\n");
         exit(3);
     }
-    len = (uint16_t) (PatLen * 256 * sizeof(uint16_t));
-    w = readFileShort(g_file);
+    len = (uint16_t)tableLen;
+    w = sig.readShort();
     if (w != len)
     {
         printf("Problem with size of T1: file %d, calc %d\n", w, len);
         return false;
     }
-    readFileSection(T1base, len, g_file);
+    const uint16_t *T1 = sig.table(tableLen);
 
-    grab(2, g_file);
-    if (memcmp("T2", buf, 2) != 0)
+    if (not sig.section("T2"))
     {
         printf("Expected 'T2'\n");
         return false;
     }
-    w = readFileShort(g_file);
+    w = sig.readShort();
     if (w != len)
     {
         printf("Problem with size of T2: file %d, calc %d\n", w, len);
         return false;
     }
-    readFileSection(T2base, len, g_file);
+    const uint16_t *T2 = sig.table(tableLen);
 
-    /* Now read the function g[] */
-    grab(2, g_file);
-    if (memcmp("gg", buf, 2) != 0)
+    /* Now the function g[] */
+    if (not sig.section("gg"))
     {
         printf("Expected 'gg'\n");
         return false;
     }
-    len = (uint16_t)(numVert * sizeof(uint16_t));
-    w = readFileShort(g_file);
+    len = (uint16_t)gLen;
+    w = sig.readShort();
     if (w != len)
     {
         printf("Problem with size of g[]: file %d, calc %d\n", w, len);
         return false;
     }
-    readFileSection(g, len, g_file);
-
+    const uint16_t *g = sig.table(gLen);
 
     /* This is now the hash table */
-    /* First allocate space for the table */
-    ht = new HT[numKeys];
-    if ( nullptr == ht)
-    {
-        printf("Could not allocate hash table\n");
-        return false;
-    }
-    grab(2, g_file);
-    if (memcmp("ht", buf, 2) != 0)
+    if (not sig.section("ht"))
     {
         printf("Expected 'ht'\n");
         return false;
     }
-    w = readFileShort(g_file);
+    w = sig.readShort();
     if (w != numKeys * (SymLen + PatLen + sizeof(uint16_t)))
     {
-        printf("Problem with size of hash table: file %d, calc %d\n", w, len);
+        printf("Problem with size of hash table: file %d, calc %d\n", w,
+               (int)(numKeys * (SymLen + PatLen + sizeof(uint16_t))));
         return false;
     }
+    table.name = name;
+    table.ht = (const HT *)sig.pos;
 
+    /* Set the parameters for the hash table */
+    if (tablesUsableInPlace())
+    {
+        table.hasher.setHashTables(
+                    numKeys,                /* The number of symbols */
+                    PatLen,                 /* The length of the pattern to be hashed */
+                    256,                    /* The character set of the pattern (0-FF) */
+                    0,                      /* Minimum pattern character value */
+                    numVert,                /* Specifies c, the sparseness of the graph. See Czech, Havas and Majewski for details */
+                    T1, T2, g);
+        return true;
+    }
+    /* Initialise the perfhlib stuff. Also allocates T1, T2, g, etc */
+    table.hasher.setHashParams(numKeys, PatLen, 256, 0, numVert);
+    readFileSection(table.hasher.readT1(), T1, tableLen);
+    readFileSection(table.hasher.readT2(), T2, tableLen);
+    readFileSection(table.hasher.readG(), g, gLen);
+    table.hasher.fuseTables();
+    return true;
+}
+
+/* Frees the signature tables, and the copies of T1, T2 and g they made */
+static void freeSigTables()
+{
+    for (SigTable &table : g_sigTables)
+        table.hasher.hashCleanup();
+    g_sigTables.clear();
+}
+
+/* Sets up the signatures from a signature pack. The section for the
+ * compiler found by checkStartup is used if the pack has one; otherwise
+ * (e.g. the compiler was not recognised) LibCheck tries all of them. */
+static bool setupFromPack(const SigPack &pack, const QString &packPath)
+{
+    const SigPack::Section *protos = pack.find("dcclibs");
+    if (protos)
+        readProtos(protos->data, protos->size, packPath);
+    else
+        readProtoFile();
 
-    for (i=0; i < numKeys; i++)
+    QString vendor = sSigName.left(sSigName.lastIndexOf('.'));
+    std::vector<const SigPack::Section *> sections;
+    if (const SigPack::Section *sig = pack.find(qPrintable(vendor)))
+        sections.push_back(sig);
+    else
     {
-        if (fread(&ht[i], 1, SymLen + PatLen, g_file) != SymLen + PatLen)
+        for (const SigPack::Section &sec : pack.sections)
         {
-            printf("Could not read signature\n");
-            return false;
+            if ((sec.size >= 4) and (memcmp(sec.data, "dccs", 4) == 0))
+                sections.push_back(&sec);
         }
+        printf("No signatures for %s in %s, trying all %d of them\n", qPrintable(vendor),
+               qPrintable(packPath), (int)sections.size());
     }
-    fclose(g_file);
-    return true;
+    for (const SigPack::Section *sec : sections)
+    {
+        g_sigTables.emplace_back();
+        if (not loadSigTable(QString("%1:%2").arg(packPath).arg(sec->name), sec->data, sec->size, g_sigTables.back()))
+            g_sigTables.pop_back();
+    }
+    return not g_sigTables.empty();
+}
+
+/* This procedure is called to initialise the library check code */
+bool SetupLibCheck(void)
+{
+    IDcc *dcc = IDcc::get();
+    QDir sigDir = dcc->dataDir("sigs");
+    freeSigTables();
+
+    /* A signature pack holds all the signature files, and the prototypes */
+    QString packPath = sigDir.absoluteFilePath(SIGPACK);
+    if (QFile::exists(packPath) and g_sigFile.load(packPath))
+    {
+        SigPack pack;
+        if (pack.open(g_sigFile.data(), g_sigFile.size))
+            return setupFromPack(pack, packPath);
+        printf("Warning: %s is not a version %d signature pack\n", qPrintable(packPath), SigPack::VERSION);
+    }
+    g_sigFile.close();
+
+    QString fpath = sigDir.absoluteFilePath(sSigName);
+    if (not g_sigFile.load(fpath))
+    {
+        printf("Warning: cannot open signature file %s\n", qPrintable(fpath));
+        return false;
+    }
+
+    readProtoFile();
+
+    g_sigTables.emplace_back();
+    if (loadSigTable(fpath, g_sigFile.data(), g_sigFile.size, g_sigTables.back()))
+        return true;
+    g_sigTables.clear();
+    return false;
 }
 
 
 void CleanupLibCheck(void)
 {
     /* Deallocate all the stuff allocated in SetupLibCheck() */
-    delete [] ht;
+    g_libMatches.clear();
+    freeSigTables();
+    g_sigFile.close();
     delete [] pFunc;
 }
 
 
+/* Returns the entry of the signatures holding the wild card fixed pattern
+    pat, or nullptr. Several tables are only tried if the compiler is not
+    known; the first one holding the pattern names the proc. */
+static const HT *findSignature(uint8_t pat[])
+{
+    for (SigTable &table : g_sigTables)
+    {
+        int h = table.hasher.hash(pat);                  /* Hash the found proc */
+        /* We always have to compare keys, because the hash function will always return a valid index */
+        if (memcmp(table.ht[h].htPat, pat, PATLEN) == 0)
+            return &table.ht[h];
+    }
+    return nullptr;
+}
+
+/* Matches the signatures of procedures at the image offsets entries before
+    they are parsed, all in one go; LibCheck then uses the results for them.
+    The patterns are gathered first, and hashed table by table with
+    hashMany, rather than one by one in between the parser's work. */
+void LibCheckBatch(const std::vector<uint32_t> &entries)
+{
+    PROG &prog(Project::get()->prog);
+    if (prog.bSigs == false)
+        return;
+    std::vector<uint32_t> offsets;
+    for (uint32_t off : entries)
+    {
+        if ((off + PATLEN <= (uint32_t)prog.cbImage) and (g_libMatches.count(off) == 0))
+            offsets.push_back(off);
+    }
+    /* The patterns, one after the other */
+    std::vector<uint8_t> pats(offsets.size() * PATLEN);
+    for (size_t i = 0; i < offsets.size(); i++)
+        prog.read(offsets[i], &pats[i * PATLEN], PATLEN);
+    for (size_t i = 0; i < offsets.size(); i++)
+        fixWildCards(&pats[i * PATLEN]);
+    std::vector<const HT *> found(offsets.size(), nullptr);
+    std::vector<int> h(offsets.size());
+    for (SigTable &table : g_sigTables)
+    {
+        table.hasher.hashMany(pats.data(), offsets.size(), h.data());
+        for (size_t i = 0; i < offsets.size(); i++)
+        {
+            if (found[i])
+                continue;                   /* An earlier table has it */
+            if (memcmp(table.ht[h[i]].htPat, &pats[i * PATLEN], PATLEN) == 0)
+                found[i] = &table.ht[h[i]];
+        }
+    }
+    g_libMatches.reserve(g_libMatches.size() + offsets.size());
+    for (size_t i = 0; i < offsets.size(); i++)
+        g_libMatches[offsets[i]] = found[i];
+}
+
 /* Check this function to see if it is a library function. Return true if
     it is, and copy its name to pProc->name
 */
@@ -437,7 +637,7 @@ bool LibCheck(Function & pProc)
 {
     PROG &prog(Project::get()->prog);
     long fileOffset;
-    int h, i, j, arg;
+    int i, j, arg;
     int Idx;
     uint8_t pat[PATLEN];
 
@@ -457,22 +657,27 @@ bool LibCheck(Function & pProc)
     }
     if(fileOffset + PATLEN > prog.cbImage)
         return false;
-    memcpy(pat, &prog.image()[fileOffset], PATLEN);
-    //memmove(pat, &prog.image()[fileOffset], PATLEN);
-    fixWildCards(pat);                  /* Fix wild cards in the copy */
-    h = g_pattern_hasher.hash(pat);                      /* Hash the found proc */
-    /* We always have to compare keys, because the hash function will always return a valid index */
-    if (memcmp(ht[h].htPat, pat, PATLEN) == 0)
+    const HT *ht;
+    auto batched = g_libMatches.find(fileOffset);
+    if (batched != g_libMatches.end())
+        ht = batched->second;
+    else
+    {
+        prog.read(fileOffset, pat, PATLEN);
+        fixWildCards(pat);                  /* Fix wild cards in the copy */
+        ht = findSignature(pat);
+    }
+    if (ht)
     {
         /* We have a match. Save the name, if not already set */
         if (pProc.name.isEmpty() )     /* Don't overwrite existing name */
         {
             /* Give proc the new name */
-            pProc.name = ht[h].htSym;
+            pProc.name = ht->htSym;
         }
         /* But is it a real library function? */
         i = NIL;
-        if ((numFunc == 0) or (i=searchPList(ht[h].htSym)) != NIL)
+        if ((numFunc == 0) or (i=searchPList(ht->htSym)) != NIL)
         {
             pProc.flg |= PROC_ISLIB; 		/* It's a lib function */
             pProc.callingConv(CConv::eCdecl);
@@ -503,7 +708,7 @@ bool LibCheck(Function & pProc)
                             break;
                         case TYPE_STR:
                         case TYPE_PTR:
-                            fprintf(stderr,"Warning assuming Large memory model\n");
+                            dccFprintf(stderr,"Warning assuming Large memory model\n");
                             pProc.liveOut.setReg(rAX).addReg(rDS);
                             break;
                         default:
@@ -522,7 +727,7 @@ bool LibCheck(Function & pProc)
             pProc.flg |= PROC_RUNTIME;		/* => is a runtime routine */
         }
     }
-    if (locatePattern(prog.image(), pProc.procEntry,
+    if (locatePattern(prog, pProc.procEntry,
                       pProc.procEntry+sizeof(pattMsChkstk),
                       pattMsChkstk, sizeof(pattMsChkstk), &Idx))
     {
@@ -537,38 +742,13 @@ bool LibCheck(Function & pProc)
 
 
 
-void grab(int n, FILE *_file)
-{
-    if (fread(buf, 1, n, _file) != (unsigned)n)
-    {
-        printf("Could not grab\n");
-        exit(11);
-    }
-}
-
-uint16_t readFileShort(FILE *f)
-{
-    uint8_t b1, b2;
-
-    if (fread(&b1, 1, 1, f) != 1)
-    {
-        printf("Could not read short\n");
-        exit(11);
-    }
-    if (fread(&b2, 1, 1, f) != 1)
-    {
-        printf("Could not read short\n");
-        exit(11);
-    }
-    return (uint16_t)(b2 << 8) + (uint16_t)b1;
-}
-
-// Read a section of the file, considering endian issues
-void readFileSection(uint16_t* p, int len, FILE* f)
+// Copy a section of the file, considering endian issues
+void readFileSection(uint16_t* p, const uint16_t *src, int len)
 {
+    const uint8_t *b = (const uint8_t *)src;
     for (int i=0; i < len; i += 2)
     {
-        *p++ = readFileShort(f);
+        *p++ = (uint16_t)(b[i+1] << 8) + (uint16_t)b[i];
     }
 }
 
@@ -587,23 +767,23 @@ void dispKey(int /*i*/)
     iPatLen). The pattern can contain wild bytes; if you really want to match
     for the pattern that is used up by the WILD uint8_t, tough - it will match with
     everything else as well. */
-static bool locatePattern(const uint8_t *source, int iMin, int iMax, uint8_t *pattern, int iPatLen,
+static bool locatePattern(const PROG &source, int iMin, int iMax, uint8_t *pattern, int iPatLen,
                            int *index)
 {
     int i, j;
-    const uint8_t *pSrc;                             /* Pointer to start of considered source */
+    int pSrc;                               /* Image offset of considered source uint8_t */
     int iLast;
 
     iLast = iMax - iPatLen;                 /* Last source uint8_t to consider */
 
     for (i=iMin; i <= iLast; i++)
     {
-        pSrc = &source[i];                  /* Start of current part of source */
+        pSrc = i;                           /* Start of current part of source */
         /* i is the index of the start of the moving pattern */
         for (j=0; j < iPatLen; j++)
         {
             /* j is the index of the uint8_t being considered in the pattern. */
-            if ((*pSrc != pattern[j]) and (pattern[j] != WILD))
+            if ((source.byte(pSrc) != pattern[j]) and (pattern[j] != WILD))
             {
                 /* A definite mismatch */
                 break;                      /* Break to outer loop */
@@ -623,6 +803,18 @@ static bool locatePattern(const uint8_t *source, int iMin, int iMax, uint8_t *pa
     return 0;                               /* Indicate failure */
 }
 
+/* Returns true if the image bytes at off are exactly the iPatLen bytes of
+ * pattern; unlike locatePattern, WILD is not special */
+static bool matchPattern(const PROG &source, int off, const uint8_t *pattern, int iPatLen)
+{
+    for (int j = 0; j < iPatLen; j++)
+    {
+        if (source.byte(off+j) != pattern[j])
+            return false;
+    }
+    return true;
+}
+
 
 void STATE::checkStartup()
 {
@@ -644,18 +836,18 @@ void STATE::checkStartup()
 
     /* Check the Turbo Pascal signatures first, since they involve only the
                 first 3 bytes, and false positives may be founf with the others later */
-    if (locatePattern(prog.image(), startOff, startOff+5, pattBorl4on,sizeof(pattBorl4on), &i))
+    if (locatePattern(prog, startOff, startOff+5, pattBorl4on,sizeof(pattBorl4on), &i))
     {
         /* The first 5 bytes are a far call. Follow that call and
                         determine the version from that */
-        rel = LH(&prog.image()[startOff+1]);  	 /* This is abs off of init */
-        para= LH(&prog.image()[startOff+3]);/* This is abs seg of init */
+        rel = prog.word(startOff+1);  	 /* This is abs off of init */
+        para= prog.word(startOff+3);/* This is abs seg of init */
         init = ((uint32_t)para << 4) + rel;
-        if (locatePattern(prog.image(), init, init+26, pattBorl4Init,
+        if (locatePattern(prog, init, init+26, pattBorl4Init,
                           sizeof(pattBorl4Init), &i))
         {
 
-            setState(rDS, LH(&prog.image()[i+1]));
+            setState(rDS, prog.word(i+1));
             printf("Borland Pascal v4 detected\n");
             chVendor = 't';                     /* Trubo */
             chModel  = 'p';						/* Pascal */
@@ -664,11 +856,11 @@ void STATE::checkStartup()
             prog.segMain = prog.initCS;			/* At the 5 uint8_t jump */
             goto gotVendor;                     /* Already have vendor */
         }
-        else if (locatePattern(prog.image(), init, init+26, pattBorl5Init,
+        else if (locatePattern(prog, init, init+26, pattBorl5Init,
                                sizeof(pattBorl5Init), &i))
         {
 
-            setState( rDS, LH(&prog.image()[i+1]));
+            setState( rDS, prog.word(i+1));
             printf("Borland Pascal v5.0 detected\n");
             chVendor = 't';                     /* Trubo */
             chModel  = 'p';						/* Pascal */
@@ -677,11 +869,11 @@ void STATE::checkStartup()
             prog.segMain = prog.initCS;
             goto gotVendor;                     /* Already have vendor */
         }
-        else if (locatePattern(prog.image(), init, init+26, pattBorl7Init,
+        else if (locatePattern(prog, init, init+26, pattBorl7Init,
                                sizeof(pattBorl7Init), &i))
         {
 
-            setState( rDS, LH(&prog.image()[i+1]));
+            setState( rDS, prog.word(i+1));
             printf("Borland Pascal v7 detected\n");
             chVendor = 't';                     /* Trubo */
             chModel  = 'p';						/* Pascal */
@@ -700,43 +892,43 @@ void STATE::checkStartup()
         as near data, just more pushes at the start. */
     if(prog.cbImage>int(startOff+0x180+sizeof(pattMainLarge)))
     {
-        if (locatePattern(prog.image(), startOff, startOff+0x180, pattMainLarge,sizeof(pattMainLarge), &i))
+        if (locatePattern(prog, startOff, startOff+0x180, pattMainLarge,sizeof(pattMainLarge), &i))
         {
-            rel = LH(&prog.image()[i+OFFMAINLARGE]);  /* This is abs off of main */
-            para= LH(&prog.image()[i+OFFMAINLARGE+2]);/* This is abs seg of main */
+            rel = prog.word(i+OFFMAINLARGE);  /* This is abs off of main */
+            para= prog.word(i+OFFMAINLARGE+2);/* This is abs seg of main */
             /* Save absolute image offset */
             prog.offMain = ((uint32_t)para << 4) + rel;
             prog.segMain = (uint16_t)para;
             chModel = 'l';                          /* Large model */
         }
-        else if (locatePattern(prog.image(), startOff, startOff+0x180, pattMainCompact,
+        else if (locatePattern(prog, startOff, startOff+0x180, pattMainCompact,
                                sizeof(pattMainCompact), &i))
         {
-            rel = LH_SIGNED(&prog.image()[i+OFFMAINCOMPACT]);/* This is the rel addr of main */
+            rel = (int16_t)prog.word(i+OFFMAINCOMPACT);/* This is the rel addr of main */
             prog.offMain = i+OFFMAINCOMPACT+2+rel;  /* Save absolute image offset */
             prog.segMain = prog.initCS;
             chModel = 'c';                          /* Compact model */
         }
-        else if (locatePattern(prog.image(), startOff, startOff+0x180, pattMainMedium,
+        else if (locatePattern(prog, startOff, startOff+0x180, pattMainMedium,
                                sizeof(pattMainMedium), &i))
         {
-            rel = LH(&prog.image()[i+OFFMAINMEDIUM]);  /* This is abs off of main */
-            para= LH(&prog.image()[i+OFFMAINMEDIUM+2]);/* This is abs seg of main */
+            rel = prog.word(i+OFFMAINMEDIUM);  /* This is abs off of main */
+            para= prog.word(i+OFFMAINMEDIUM+2);/* This is abs seg of main */
             prog.offMain = ((uint32_t)para << 4) + rel;
             prog.segMain = (uint16_t)para;
             chModel = 'm';                          /* Medium model */
         }
-        else if (locatePattern(prog.image(), startOff, startOff+0x180, pattMainSmall,
+        else if (locatePattern(prog, startOff, startOff+0x180, pattMainSmall,
                                sizeof(pattMainSmall), &i))
         {
-            rel = LH_SIGNED(&prog.image()[i+OFFMAINSMALL]); /* This is rel addr of main */
+            rel = (int16_t)prog.word(i+OFFMAINSMALL); /* This is rel addr of main */
             prog.offMain = i+OFFMAINSMALL+2+rel;    /* Save absolute image offset */
             prog.segMain = prog.initCS;
             chModel = 's';                          /* Small model */
         }
-        else if (memcmp(&prog.image()[startOff], pattTPasStart, sizeof(pattTPasStart)) == 0)
+        else if (matchPattern(prog, startOff, pattTPasStart, sizeof(pattTPasStart)))
         {
-            rel = LH_SIGNED(&prog.image()[startOff+1]);     /* Get the jump offset */
+            rel = (int16_t)prog.word(startOff+1);     /* Get the jump offset */
             prog.offMain = rel+startOff+3;          /* Save absolute image offset */
             prog.offMain += 0x20;                   /* These first 32 bytes are setting up */
             prog.segMain = prog.initCS;
@@ -763,55 +955,55 @@ void STATE::checkStartup()
     prog.addressingMode = chModel;
 
     /* Now decide the compiler vendor and version number */
-    if (memcmp(&prog.image()[startOff], pattMsC5Start, sizeof(pattMsC5Start)) == 0)
+    if (matchPattern(prog, startOff, pattMsC5Start, sizeof(pattMsC5Start)))
     {
         /* Yes, this is Microsoft startup code. The DS is sitting right here
             in the next 2 bytes */
-        setState( rDS, LH(&prog.image()[startOff+sizeof(pattMsC5Start)]));
+        setState( rDS, prog.word(startOff+sizeof(pattMsC5Start)));
         chVendor = 'm';                     /* Microsoft compiler */
         chVersion = '5';                    /* Version 5 */
         printf("MSC 5 detected\n");
     }
 
     /* The C8 startup pattern is different from C5's */
-    else if (memcmp(&prog.image()[startOff], pattMsC8Start, sizeof(pattMsC8Start)) == 0)
+    else if (matchPattern(prog, startOff, pattMsC8Start, sizeof(pattMsC8Start)))
     {
-        setState( rDS, LH(&prog.image()[startOff+sizeof(pattMsC8Start)]));
+        setState( rDS, prog.word(startOff+sizeof(pattMsC8Start)));
         printf("MSC 8 detected\n");
         chVendor = 'm';                     /* Microsoft compiler */
         chVersion = '8';                    /* Version 8 */
     }
 
     /* The C8 .com startup pattern is different again! */
-    else if (memcmp(&prog.image()[startOff], pattMsC8ComStart,
-                    sizeof(pattMsC8ComStart)) == 0)
+    else if (matchPattern(prog, startOff, pattMsC8ComStart,
+                    sizeof(pattMsC8ComStart)))
     {
         printf("MSC 8 .com detected\n");
         chVendor = 'm';                     /* Microsoft compiler */
         chVersion = '8';                    /* Version 8 */
     }
 
-    else if (locatePattern(prog.image(), startOff, startOff+0x30, pattBorl2Start,
+    else if (locatePattern(prog, startOff, startOff+0x30, pattBorl2Start,
                            sizeof(pattBorl2Start), &i))
     {
         /* Borland startup. DS is at the second uint8_t (offset 1) */
-        setState( rDS, LH(&prog.image()[i+1]));
+        setState( rDS, prog.word(i+1));
         printf("Borland v2 detected\n");
         chVendor = 'b';                     /* Borland compiler */
         chVersion = '2';                    /* Version 2 */
     }
 
-    else if (locatePattern(prog.image(), startOff, startOff+0x30, pattBorl3Start,
+    else if (locatePattern(prog, startOff, startOff+0x30, pattBorl3Start,
                            sizeof(pattBorl3Start), &i))
     {
         /* Borland startup. DS is at the second uint8_t (offset 1) */
-        setState( rDS, LH(&prog.image()[i+1]));
+        setState( rDS, prog.word(i+1));
         printf("Borland v3 detected\n");
         chVendor = 'b';                     /* Borland compiler */
         chVersion = '3';                    /* Version 3 */
     }
 
-    else if (locatePattern(prog.image(), startOff, startOff+0x30, pattLogiStart,
+    else if (locatePattern(prog, startOff, startOff+0x30, pattLogiStart,
                            sizeof(pattLogiStart), &i))
     {
         /* Logitech modula startup. DS is 0, despite appearances */
@@ -849,73 +1041,81 @@ void readProtoFile()
     IDcc *dcc = IDcc::get();
     QString szProFName = dcc->dataDir("prototypes").absoluteFilePath(DCCLIBS); /* Full name of dclibs.lst */
 
-    FILE *fProto;
-    int  i;
-
-    if ((fProto = fopen(qPrintable(szProFName), "rb")) == nullptr)
+    QFile fProto(szProFName);
+    if (not fProto.open(QFile::ReadOnly))
     {
         printf("Warning: cannot open library prototype data file %s\n", qPrintable(szProFName));
         return;
     }
+    QByteArray contents = fProto.readAll();
+    readProtos((const uint8_t *)contents.constData(), contents.size(), szProFName);
+}
+
+/* Reads the prototypes file held in data, which is named name in messages */
+void readProtos(const uint8_t *data, size_t size, const QString &name)
+{
+    SigReader proto {data, data + size};
+    auto need = [&](size_t n) {
+        if ((size_t)(proto.end - proto.pos) < n)
+        {
+            printf("%s is truncated\n", qPrintable(name));
+            exit(11);
+        }
+    };
+    int  i;
 
-    grab(4, fProto);
-    if (strncmp(buf, "dccp", 4) != 0)
+    need(4);
+    if (strncmp((const char *)proto.pos, "dccp", 4) != 0)
     {
-        printf("%s is not a dcc prototype file\n", qPrintable(szProFName));
+        printf("%s is not a dcc prototype file\n", qPrintable(name));
         exit(1);
     }
+    proto.pos += 4;
 
-    grab(2, fProto);
-    if (strncmp(buf, "FN", 2) != 0)
+    need(4);
+    if (not proto.section("FN"))
     {
-        printf("FN (Function Name) subsection expected in %s\n", qPrintable(szProFName));
+        printf("FN (Function Name) subsection expected in %s\n", qPrintable(name));
         exit(2);
     }
 
-    numFunc = readFileShort(fProto);     /* Num of entries to allocate */
+    numFunc = proto.readShort();     /* Num of entries to allocate */
 
     /* Allocate exactly correct # entries */
     pFunc = new PH_FUNC_STRUCT[numFunc];
 
     for (i=0; i < numFunc; i++)
     {
-        size_t read_size=fread(&pFunc[i], 1, SYMLEN, fProto);
-        assert(read_size==SYMLEN);
-        if(read_size!=SYMLEN)
-            break;
-        pFunc[i].typ      = (hlType)readFileShort(fProto);
-        pFunc[i].numArg   = readFileShort(fProto);
-        pFunc[i].firstArg = readFileShort(fProto);
-        if(feof(fProto))
-            break;
-        int c = fgetc(fProto);
-        pFunc[i].bVararg = (c!=0); //fread(&pFunc[i].bVararg, 1, 1, fProto);
+        need(SYMLEN + 3*sizeof(uint16_t) + 1);
+        memcpy(pFunc[i].name, proto.pos, SYMLEN);
+        proto.pos += SYMLEN;
+        pFunc[i].typ      = (hlType)proto.readShort();
+        pFunc[i].numArg   = proto.readShort();
+        pFunc[i].firstArg = proto.readShort();
+        pFunc[i].bVararg = (*proto.pos++ != 0);
     }
 
-    grab(2, fProto);
-    if (strncmp(buf, "PM", 2) != 0)
+    need(4);
+    if (not proto.section("PM"))
     {
-        printf("PM (Parameter) subsection expected in %s\n", qPrintable(szProFName));
+        printf("PM (Parameter) subsection expected in %s\n", qPrintable(name));
         exit(2);
     }
 
-    numArg = readFileShort(fProto);     /* Num of entries to allocate */
+    numArg = proto.readShort();     /* Num of entries to allocate */
 
     /* Allocate exactly correct # entries */
     delete [] pArg;
     pArg = new hlType[numArg];
 
+    need(numArg * sizeof(uint16_t));
     for (i=0; i < numArg; i++)
     {
-        //      fread(&pArg[i], 1, SYMLEN, fProto);     /* No names to read as yet */
-        pArg[i] = (hlType) readFileShort(fProto);
+        pArg[i] = (hlType) proto.readShort();
     }
-
-    fclose(fProto);
-
 }
 
-int searchPList(char *name)
+int searchPList(const char *name)
 {
     /* Search through the symbol names for the name */
     /* Use binary search */
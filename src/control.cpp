@@ -11,10 +11,39 @@
 #include <cstdio>
 #include <cstring>
 #include <algorithm>
-#include <list>
+#include <vector>
 
 namespace {
-using nodeList = std::list<int>; /* dfsLast index to the node */
+using nodeList = std::vector<int>; /* dfsLast index to the node */
+
+/* Set of nodes given by their dfsLast index: a dense bitmap for membership
+ * tests, plus the members in insertion order for iteration and clearing */
+class NodeSet
+{
+    std::vector<bool>   m_member;
+    nodeList            m_order;
+public:
+    explicit NodeSet(size_t numNodes) : m_member(numNodes,false) {}
+    bool contains(int n) const
+    {
+        return (n >= 0) and (size_t(n) < m_member.size()) and m_member[n];
+    }
+    void insert(int n)
+    {
+        if (contains(n))
+            return;
+        m_member[n] = true;
+        m_order.push_back(n);
+    }
+    void clear()
+    {
+        for (int n : m_order)
+            m_member[n] = false;
+        m_order.clear();
+    }
+    nodeList::const_iterator begin() const { return m_order.begin(); }
+    nodeList::const_iterator end() const { return m_order.end(); }
+};
 
 /* there is a path on the DFST from a to b if the a was first visited in a
  * dfs, and a was later visited than b when doing the last visit of each
@@ -40,45 +69,20 @@ bool isBackEdge (BB * p,BB * s)
 }
 
 
-/** Finds the common dominator of the current immediate dominator
- * currImmDom and its predecessor's immediate dominator predImmDom  */
-int commonDom (int currImmDom, int predImmDom, Function * pProc)
-{
-    if (currImmDom == NO_DOM)
-        return (predImmDom);
-    if (predImmDom == NO_DOM)   /* predecessor is the root */
-        return (currImmDom);
-
-    while ((currImmDom != NO_DOM) and (predImmDom != NO_DOM) and
-           (currImmDom != predImmDom))
-    {
-        if (currImmDom < predImmDom)
-            predImmDom = pProc->m_dfsLast[predImmDom]->immedDom;
-        else
-            currImmDom = pProc->m_dfsLast[currImmDom]->immedDom;
-    }
-    return (currImmDom);
-}
-/* Returns whether or not the node n (dfsLast numbering of a basic block)
- * is on the list l. */
-bool inList (const nodeList &l, int n)
-{
-    return std::find(l.begin(),l.end(),n)!=l.end();
-}
-/* Returns whether the node n belongs to the queue list q. */
-bool inInt(BB * n, queue &q)
+/* Returns whether the node n belongs to the set of interval nodes q. */
+bool inInt(BB * n, const NodeSet &q, Function * pProc)
 {
-    return std::find(q.begin(),q.end(),n)!=q.end();
+    return q.contains(n->dfsLastNum) and (pProc->m_dfsLast[n->dfsLastNum] == n);
 }
 /** Recursive procedure to find nodes that belong to the interval (ie. nodes
  * from G1).                                */
-void findNodesInInt (queue &intNodes, int level, interval *Ii)
+void findNodesInInt (NodeSet &intNodes, int level, interval *Ii)
 {
     if (level == 1)
     {
         for(BB *en : Ii->nodes)
         {
-            appendQueue(intNodes,en);
+            intNodes.insert(en->dfsLastNum);
         }
     }
     else
@@ -91,7 +95,7 @@ void findNodesInInt (queue &intNodes, int level, interval *Ii)
 }
 /* Finds the follow of the endless loop headed at node head (if any).
  * The follow node is the closest node to the loop. */
-void findEndlessFollow (Function * pProc, nodeList &loopNodes, BB * head)
+void findEndlessFollow (Function * pProc, const NodeSet &loopNodes, BB * head)
 {
     head->loopFollow = MAX;
     for( int loop_node :  loopNodes)
@@ -99,20 +103,19 @@ void findEndlessFollow (Function * pProc, nodeList &loopNodes, BB * head)
         for (const TYPEADR_TYPE &typeaddr: pProc->m_dfsLast[loop_node]->edges)
         {
             int succ = typeaddr.BBptr->dfsLastNum;
-            if ((not inList(loopNodes, succ)) and (succ < head->loopFollow))
+            if ((not loopNodes.contains(succ)) and (succ < head->loopFollow))
                 head->loopFollow = succ;
         }
     }
 }
 
 
-//static void findNodesInLoop(BB * latchNode,BB * head,PPROC pProc,queue *intNodes)
 /* Flags nodes that belong to the loop determined by (latchNode, head) and
  * determines the type of loop.                     */
-void findNodesInLoop(BB * latchNode,BB * head,Function * pProc,queue &intNodes)
+void findNodesInLoop(BB * latchNode,BB * head,Function * pProc,const NodeSet &intNodes)
 {
     int i, headDfsNum, intNodeType;
-    nodeList loopNodes;
+    NodeSet loopNodes(pProc->numBBs);
     int immedDom,     		/* dfsLast index to immediate dominator */
         thenDfs, elseDfs;       /* dsfLast index for THEN and ELSE nodes */
     BB * pbb;
@@ -120,31 +123,34 @@ void findNodesInLoop(BB * latchNode,BB * head,Function * pProc,queue &intNodes)
     /* Flag nodes in loop headed by head (except header node) */
     headDfsNum = head->dfsLastNum;
     head->loopHead = headDfsNum;
-    loopNodes.push_back(headDfsNum);
+    loopNodes.insert(headDfsNum);
     for (i = headDfsNum + 1; i < latchNode->dfsLastNum; i++)
     {
         if (pProc->m_dfsLast[i]->flg & INVALID_BB)	/* skip invalid BBs */
             continue;
+        /* Every node of the loop is dominated by its header */
+        if (not pProc->m_domTree.dominates(headDfsNum, i))
+            continue;
 
         immedDom = pProc->m_dfsLast[i]->immedDom;
-        if (inList (loopNodes, immedDom) and inInt(pProc->m_dfsLast[i], intNodes))
+        if (loopNodes.contains(immedDom) and intNodes.contains(i))
         {
-            loopNodes.push_back(i);
+            loopNodes.insert(i);
             if (pProc->m_dfsLast[i]->loopHead == NO_NODE)/*not in other loop*/
                 pProc->m_dfsLast[i]->loopHead = headDfsNum;
         }
     }
     latchNode->loopHead = headDfsNum;
     if (latchNode != head)
-        loopNodes.push_back(latchNode->dfsLastNum);
+        loopNodes.insert(latchNode->dfsLastNum);
 
     /* Determine type of loop and follow node */
     intNodeType = head->nodeType;
     if (latchNode->nodeType == TWO_BRANCH)
         if ((intNodeType == TWO_BRANCH) or (latchNode == head))
             if ((latchNode == head) or
-                (inList (loopNodes, head->edges[THEN].BBptr->dfsLastNum) and
-                 inList (loopNodes, head->edges[ELSE].BBptr->dfsLastNum)))
+                (loopNodes.contains(head->edges[THEN].BBptr->dfsLastNum) and
+                 loopNodes.contains(head->edges[ELSE].BBptr->dfsLastNum)))
             {
                 head->loopType = eNodeHeaderType::REPEAT_TYPE;
                 if (latchNode->edges[0].BBptr == head)
@@ -156,7 +162,7 @@ void findNodesInLoop(BB * latchNode,BB * head,Function * pProc,queue &intNodes)
             else
             {
                 head->loopType = eNodeHeaderType::WHILE_TYPE;
-                if (inList (loopNodes, head->edges[THEN].BBptr->dfsLastNum))
+                if (loopNodes.contains(head->edges[THEN].BBptr->dfsLastNum))
                     head->loopFollow = head->edges[ELSE].BBptr->dfsLastNum;
                 else
                     head->loopFollow = head->edges[THEN].BBptr->dfsLastNum;
@@ -215,8 +221,6 @@ void findNodesInLoop(BB * latchNode,BB * head,Function * pProc,queue &intNodes)
             head->loopType = eNodeHeaderType::ENDLESS_TYPE;
             findEndlessFollow (pProc, loopNodes, head);
         }
-
-    loopNodes.clear();
 }
 /** \returns whether the BB indexed by s is a successor of the BB indexed by \arg h
  *  \note that h is a case node.
@@ -234,15 +238,15 @@ bool successor (int s, int h, Function * pProc)
 /** Recursive procedure to tag nodes that belong to the case described by
  * the list l, head and tail (dfsLast index to first and exit node of the
  * case).                               */
-void tagNodesInCase (BB * pBB, nodeList &l, int head, int tail)
+void tagNodesInCase (BB * pBB, NodeSet &l, int head, int tail)
 {
     int current;      /* index to current node */
 
     pBB->traversed = DFS_CASE;
     current = pBB->dfsLastNum;
-    if ((current != tail) and (pBB->nodeType != MULTI_BRANCH) and (inList (l, pBB->immedDom)))
+    if ((current != tail) and (pBB->nodeType != MULTI_BRANCH) and (l.contains(pBB->immedDom)))
     {
-        l.push_back(current);
+        l.insert(current);
         pBB->caseHead = head;
         for(TYPEADR_TYPE &edge : pBB->edges)
         {
@@ -266,64 +270,80 @@ void flagNodes (nodeList &l, int f, Function * pProc)
 
 } // end of anonymouse namespace
 
-/** Finds the immediate dominator of each node in the graph pProc->cfg.
- * Adapted version of the dominators algorithm by Hecht and Ullman; finds
- * immediate dominators only.
- * Note: graph should be reducible */
+/** Builds the dominator tree of the graph pProc->cfg, and records the
+ * immediate dominator of each node in its BB.
+ * The root of the tree is the first valid node in dfsLast order. */
 void Function::findImmedDom ()
 {
-    BB * currNode;
+    std::vector<int> predStart(numBBs+1,0), preds;
+    int root = DominatorTree::UNDEFINED;
     for (size_t currIdx = 0; currIdx < numBBs; currIdx++)
     {
-        currNode = m_dfsLast[currIdx];
-        if (currNode->flg & INVALID_BB)		/* Do not process invalid BBs */
+        BB * currNode = m_dfsLast[currIdx];
+        predStart[currIdx] = preds.size();
+        if ((currNode == nullptr) or (currNode->flg & INVALID_BB))	/* Do not process invalid BBs */
             continue;
+        if (root == DominatorTree::UNDEFINED)
+            root = currIdx;
         for (BB * inedge : currNode->inEdges)
         {
             size_t predIdx = inedge->dfsLastNum;
-            if (predIdx < currIdx)
-                currNode->immedDom = commonDom (currNode->immedDom, predIdx, this);
+            if ((predIdx < numBBs) and (m_dfsLast[predIdx] == inedge) and not (inedge->flg & INVALID_BB))
+                preds.push_back(predIdx);
         }
     }
+    predStart[numBBs] = preds.size();
+    m_domTree.clear();
+    if (root == DominatorTree::UNDEFINED)
+        return;
+    m_domTree.build(root, predStart, preds);
+
+    for (size_t currIdx = 0; currIdx < numBBs; currIdx++)
+    {
+        BB * currNode = m_dfsLast[currIdx];
+        if ((currNode == nullptr) or (currNode->flg & INVALID_BB))
+            continue;
+        int idom = m_domTree.immedDom(currIdx);
+        currNode->immedDom = (idom == DominatorTree::UNDEFINED) ? NO_DOM : idom;
+    }
 }
 
 
 /** Algorithm for structuring loops */
 void Function::structLoops(derSeq *derivedG)
 {
-    interval *Ii;
     BB * intHead,      	/* interval header node         	*/
             * pred,     /* predecessor node         		*/
             * latchNode;/* latching node (in case of loops) */
     size_t  level = 0;  /* derived sequence level       	*/
     interval *initInt;  /* initial interval         		*/
-    queue intNodes;  	/* list of interval nodes       	*/
+    NodeSet intNodes(numBBs);  	/* set of interval nodes       	*/
 
     /* Structure loops */
     /* for all derived sequences Gi */
     for(auto & elem : derivedG->entries)
     {
         level++;
-        for (Ii = elem.Ii; Ii!=nullptr; Ii = Ii->next)       /* for all intervals Ii of Gi */
+        for (interval &Ii : elem.m_intervals)       /* for all intervals Ii of Gi */
         {
             latchNode = nullptr;
             intNodes.clear();
 
             /* Find interval head (original BB node in G1) and create
            * list of nodes of interval Ii.              */
-            initInt = Ii;
+            initInt = &Ii;
             for (size_t i = 1; i < level; i++)
                 initInt = initInt->nodes.front()->correspInt;
             intHead = initInt->nodes.front();
 
             /* Find nodes that belong to the interval (nodes from G1) */
-            findNodesInInt (intNodes, level, Ii);
+            findNodesInInt (intNodes, level, &Ii);
 
             /* Find greatest enclosing back edge (if any) */
             for (size_t i = 0; i < intHead->inEdges.size(); i++)
             {
                 pred = intHead->inEdges[i];
-                if (inInt(pred, intNodes) and isBackEdge(pred, intHead))
+                if (inInt(pred, intNodes, this) and isBackEdge(pred, intHead))
                 {
                     if (nullptr == latchNode)
                         latchNode = pred;
@@ -356,7 +376,7 @@ void Function::structLoops(derSeq *derivedG)
 void Function::structCases()
 {
     int exitNode = NO_NODE;   	/* case exit node           */
-    nodeList caseNodes;   /* temporary: list of nodes in case */
+    NodeSet caseNodes(numBBs);   /* temporary: set of nodes in case */
 
     /* Linear scan of the nodes in reverse dfsLast order, searching for
      * case nodes                           */
@@ -368,9 +388,9 @@ void Function::structCases()
 
         /* Find descendant node which has as immediate predecessor
                          * the current header node, and is not a successor.    */
-        for (size_t j = i + 2; j < numBBs; j++)
+        for (int j : m_domTree.children(i))
         {
-            if ((not successor(j, i, this)) and (m_dfsLast[j]->immedDom == i))
+            if ((j >= i + 2) and (not successor(j, i, this)))
             {
                 if (exitNode == NO_NODE)
                     exitNode = j;
@@ -382,7 +402,7 @@ void Function::structCases()
 
         /* Tag nodes that belong to the case by recording the
                          * header field with caseHeader.           */
-        caseNodes.push_back(i);
+        caseNodes.insert(i);
         m_dfsLast[i]->caseHead = i;
         for(TYPEADR_TYPE &pb : caseHeader->edges)
         {
@@ -421,17 +441,14 @@ void Function::structIfs ()
             follow = 0;
 
             /* Find all nodes that have this node as immediate dominator */
-            for (size_t desc = curr+1; desc < numBBs; desc++)
+            for (int desc : m_domTree.children(curr))
             {
-                if (m_dfsLast[desc]->immedDom == curr)
+                domDesc.push_back(desc);
+                pbb = m_dfsLast[desc];
+                if ((pbb->inEdges.size() - pbb->numBackEdges) >= followInEdges)
                 {
-                    domDesc.push_back(desc);
-                    pbb = m_dfsLast[desc];
-                    if ((pbb->inEdges.size() - pbb->numBackEdges) >= followInEdges)
-                    {
-                        follow = desc;
-                        followInEdges = pbb->inEdges.size() - pbb->numBackEdges;
-                    }
+                    follow = desc;
+                    followInEdges = pbb->inEdges.size() - pbb->numBackEdges;
                 }
             }
 
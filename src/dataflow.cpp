@@ -61,7 +61,7 @@ Expr *srcIdent (const LLInst &ll_insn, Function * pProc, iICODE i, ICODE & duIco
     if (src_op->isImmediate())   /* immediate operand ll_insn.testFlags(I)*/
     {
         //if (ll_insn.testFlags(B))
-        return new Constant(src_op->getImm2(), src_op->byteWidth());
+        return Constant::Create(src_op->getImm2(), src_op->byteWidth());
     }
     // otherwise
     return AstIdent::id (ll_insn, SRC, pProc, i, duIcode, du);
@@ -207,7 +207,7 @@ void Function::elimCondCodes ()
                         lhs = defIcode.hl()->asgn.lhs()->clone();
                         useAt->copyDU(*defAt, eUSE, eDEF);
                         //if (defAt->ll()->testFlags(B))
-                        rhs = new Constant(0, dest_ll->byteWidth());
+                        rhs = Constant::Create(0, dest_ll->byteWidth());
                         break;
 
                     case iTEST:
@@ -215,13 +215,13 @@ void Function::elimCondCodes ()
                         lhs = dstIdent (*defIcode.ll(),this, befDefAt,*useAt, eUSE);
                         lhs = BinaryOperator::And(lhs, rhs);
                         //                            if (defAt->ll()->testFlags(B))
-                        rhs = new Constant(0, dest_ll->byteWidth());
+                        rhs = Constant::Create(0, dest_ll->byteWidth());
                         break;
                     case iINC:
                     case iDEC: //WARNING: verbatim copy from iOR needs fixing ?
                         lhs = defIcode.hl()->asgn.lhs()->clone();
                         useAt->copyDU(*defAt, eUSE, eDEF);
-                        rhs = new Constant(0, dest_ll->byteWidth());
+                        rhs = Constant::Create(0, dest_ll->byteWidth());
                         break;
                     default:
                         notSup = true;
@@ -243,7 +243,7 @@ void Function::elimCondCodes ()
                     //NOTICE: was rCX, 0
                     lhs = new RegisterNode(LLOperand(rCX, 0 ), &localId);
                     useAt->setRegDU (rCX, eUSE);
-                    rhs = new Constant(0, 2);
+                    rhs = Constant::Create(0, 2);
                     _expr = BinaryOperator::Create(EQUAL,lhs,rhs);
                     useAt->setJCond(_expr);
                 }
@@ -326,25 +326,37 @@ void Function::liveRegAnalysis (LivenessSet &in_liveOut)
     Function * pcallee;     /* invoked subroutine               */
     //ICODE  *ticode        /* icode that invokes a subroutine  */
     ;
-    LivenessSet prevLiveOut,	/* previous live out 				*/
-            prevLiveIn;		/* previous live in					*/
-    bool change;			/* is there change in the live sets?*/
+    LivenessSet prevLiveIn;		/* previous live in					*/
+    std::vector<bool> pending(m_dfsLast.size(),false); /* BBs on the worklist, by dfsLastNum */
+    size_t numPending=0;
 
     /* liveOut for this procedure */
     liveOut = in_liveOut;
 
-    change = true;
-    while (change)
+    /* Initially all valid nodes are on the worklist */
+    for(BB *pbb : m_dfsLast | filtered(BB::ValidFunctor()))
+    {
+        pending[pbb->dfsLastNum] = true;
+        numPending++;
+    }
+    liveStats = LiveAnalysisStats();
+    while (numPending)
     {
-        /* Process nodes in reverse postorder order */
-        change = false;
-        auto valid_reversed_bbs = (m_dfsLast | reversed | filtered(BB::ValidFunctor()) );
-        for( BB * pbb : valid_reversed_bbs) // for each valid pbb in reversed dfs order
+        /* Process pending nodes in reverse postorder order. A node queued
+         * behind the current one is handled in this pass, otherwise in the
+         * next one. */
+        liveStats.passes++;
+        for (int idx = int(m_dfsLast.size())-1; idx>=0; --idx)
         {
+            if (not pending[idx])
+                continue;
+            pending[idx] = false;
+            numPending--;
+            liveStats.blockVisits++;
+            BB *pbb = m_dfsLast[idx];
 
-            /* Get current liveIn() and liveOut() sets */
+            /* Get current liveIn() set */
             prevLiveIn  = pbb->liveIn;
-            prevLiveOut = pbb->liveOut;
 
             /* liveOut(b) = U LiveIn(s); where s is successor(b)
              * liveOut(b) = {liveOut}; when b is a HLI_RET node     */
@@ -420,11 +432,21 @@ void Function::liveRegAnalysis (LivenessSet &in_liveOut)
             /* liveIn(b) = liveUse(b) U (liveOut(b) - def(b) */
             pbb->liveIn = LivenessSet(pbb->liveUse + (pbb->liveOut - pbb->def));
 
-            /* Check if live sets have been modified */
-            if ((prevLiveIn != pbb->liveIn) or (prevLiveOut != pbb->liveOut))
-                change = true;
+            /* Only the predecessors read liveIn(b); requeue them if it changed */
+            if (prevLiveIn == pbb->liveIn)
+                continue;
+            for (BB *pred : pbb->inEdges)
+            {
+                int predIdx = pred->dfsLastNum;
+                if (not pred->valid() or (predIdx<0) or (size_t(predIdx)>=m_dfsLast.size()) or
+                        (m_dfsLast[predIdx]!=pred) or pending[predIdx])
+                    continue;
+                pending[predIdx] = true;
+                numPending++;
+            }
         }
     }
+    stats.totalLiveVisits += liveStats.blockVisits;
     BB *pbb = m_dfsLast.front();
     /* Propagate liveIn(b) to procedure header */
     if (pbb->liveIn.any())   /* uses registers */
@@ -710,7 +732,7 @@ int C_CallingConvention::processCArg (Function * callee, Function * pProc, ICODE
                                     size_of_arg += 2;
                                 }
                             } else if(idn) {
-                                Expr *tmp1 = new Constant(2,1);
+                                Expr *tmp1 = Constant::Create(2,1);
                                 Expr *tmp2 = BinaryOperator::createSHL(_exp,tmp1);
                                 _exp = BinaryOperator::CreateAdd(g_exp_stk.top(),tmp2);
                                 g_exp_stk.pop(); // pop segment
@@ -1279,6 +1301,7 @@ void Function::preprocessReturnDU(LivenessSet &_liveOut)
  \note indirect recursion in liveRegAnalysis is possible. */
 void Function::dataFlow(LivenessSet &_liveOut)
 {
+    ExprArena::Scope exprScope(m_exprs);   /* nests with the caller's scope */
 
     /* Remove references to register variables */
     if (flg & SI_REGVAR)
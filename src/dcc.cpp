@@ -11,6 +11,7 @@
 #include "CallGraph.h"
 #include "DccFrontend.h"
 
+#include <algorithm>
 #include <cstring>
 #include <iostream>
 #include <QtCore/QCoreApplication>
@@ -23,7 +24,7 @@
 /* Global variables - extern to other modules */
 extern QString asm1_name, asm2_name;     /* Assembler output filenames     */
 extern SYMTAB  symtab;             /* Global symbol table      			  */
-extern STATS   stats;              /* cfg statistics       				  */
+extern thread_local STATS stats;   /* cfg statistics                      */
 extern OPTION  option;             /* Command line options     			  */
 
 static void displayTotalStats();
@@ -59,6 +60,15 @@ void setupOptions(const QCoreApplication &app) {
     parser.addOption(targetFileOption);
     parser.addOption(assembly);
     parser.addOption(entryPointOption);
+    QCommandLineOption jobsOption(QStringList() << "j" << "jobs",
+                                  QCoreApplication::translate("main", "Analyse procedures on <count> threads"),
+                                  QCoreApplication::translate("main", "count"),
+                                  "1"
+                                  );
+    parser.addOption(jobsOption);
+    QCommandLineOption predecodeOption(QStringList() << "predecode",
+                                       QCoreApplication::translate("main", "Decode the whole image before parsing"));
+    parser.addOption(predecodeOption);
     //parser.addOption(forceOption);
     // Process the actual command line arguments given by the user
     parser.addPositionalArgument("source", QCoreApplication::translate("main", "Dos Executable file to decompile."));
@@ -81,6 +91,8 @@ void setupOptions(const QCoreApplication &app) {
     option.Calls = parser.isSet(boolOpts[2]);
     option.filename = args.first();
     option.CustomEntryPoint = parser.value(entryPointOption).toUInt(nullptr,16);
+    option.Jobs = std::max(1,parser.value(jobsOption).toInt());
+    option.PreDecode = parser.isSet(predecodeOption);
     if(parser.isSet(targetFileOption)) {
         asm1_name = asm2_name = parser.value(targetFileOption);
     }
@@ -147,4 +159,5 @@ displayTotalStats ()
     printf ("  Total number of high-level Icodes: %d\n", stats.totalHL);
     printf ("  Total reduction of instructions  : %2.2f%%\n", 100.0 -
             (stats.totalHL * 100.0) / stats.totalLL);
+    printf ("  Live analysis basic block visits : %d\n", stats.totalLiveVisits);
 }
@@ -203,7 +203,7 @@ void Disassembler::disassem(Function * ppProc)
 
     }
 
-    pc.entries.clear();
+    pc.clear();
     destroySymTables();
 }
 /****************************************************************************
@@ -259,7 +259,7 @@ void Disassembler::dis1Line(LLInst &inst,int loc_ip, int pass)
         {
             for (j = 0; j < cb; j++)
             {
-                hex_bytes += QString("%1").arg(uint16_t(prog.image()[inst.label + j]),2,16,QChar('0')).toUpper();
+                hex_bytes += QString("%1").arg(uint16_t(prog.byte(inst.label + j)),2,16,QChar('0')).toUpper();
             }
             hex_bytes += ' ';
         }
@@ -488,12 +488,9 @@ void Disassembler::dis1Line(LLInst &inst,int loc_ip, int pass)
     oper_stream << qSetFieldWidth(15) << opcode_with_mods << qSetFieldWidth(0) << operands_contents;
     /* Comments */
     fImpure = false;
-    if (!inst.testFlags(SYNTHETIC))
+    if (!inst.testFlags(SYNTHETIC) and (inst.label > 0) and (inst.label < nextInst))
     {
-        for (j = inst.label; j > 0 and j < (int)nextInst; j++)
-        {
-            fImpure |= BITMAP(j, BM_DATA);
-        }
+        fImpure = prog.map.any(inst.label, nextInst - inst.label, BM_DATA);
     }
     result_stream.setFieldWidth(54);
     result_stream.setFieldAlignment(QTextStream::AlignLeft);
@@ -6,11 +6,16 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <map>
+#include <mutex>
 #include <string>
 #include <stdarg.h>
 
 #include "dcc.h"
 
+#include <QtCore/QDebug>
+
+static int vdccFprintf(FILE *stream, const char *format, va_list args);
+
 static const std::map<eErrorId,std::string> errorMessage =
 {
     {INVALID_ARG      ,"Invalid option -%c\n"},
@@ -77,9 +82,85 @@ void reportError(eErrorId errId, ...)
 #else           /* msdos or windows*/
     va_start(args, errId);
 #endif
-    fprintf(stderr, "dcc: ");
+    dccFprintf(stderr, "dcc: ");
     auto msg_iter = errorMessage.find(errId);
     assert(msg_iter!=errorMessage.end());
-    vfprintf(stderr, msg_iter->second.c_str(), args);
+    vdccFprintf(stderr, msg_iter->second.c_str(), args);
+    va_end(args);
+}
+
+/****************************************************************************
+ DiagnosticLog: per thread capture of diagnostic output.
+ ****************************************************************************/
+static thread_local DiagnosticLog *s_threadLog = nullptr;
+static QtMessageHandler s_qtHandler = nullptr;    /* handler replaced by ours */
+
+static void logMessage(QtMsgType type, const QMessageLogContext &ctx, const QString &msg)
+{
+    if (s_threadLog)
+        s_threadLog->append(nullptr, type, msg.toStdString());
+    else
+        s_qtHandler(type, ctx, msg);
+}
+
+void DiagnosticLog::capture(DiagnosticLog *log)
+{
+    static std::once_flag installed;
+    std::call_once(installed, []() { s_qtHandler = qInstallMessageHandler(logMessage); });
+    s_threadLog = log;
+}
+
+
+void DiagnosticLog::replay()
+{
+    replayUpTo(m_entries.size());
+    m_entries.clear();
+    m_replayed = 0;
+}
+
+void DiagnosticLog::replayUpTo(size_t upTo)
+{
+    for (; m_replayed < upTo; ++m_replayed)
+    {
+        const Entry &e(m_entries[m_replayed]);
+        if (e.stream)
+            fputs(e.text.c_str(), e.stream);
+        else
+            s_qtHandler(QtMsgType(e.msgType), QMessageLogContext(), QString::fromStdString(e.text));
+    }
+}
+
+static int vdccFprintf(FILE *stream, const char *format, va_list args)
+{
+    if (s_threadLog == nullptr)
+        return vfprintf(stream, format, args);
+    va_list copy;
+    va_copy(copy, args);
+    int len = vsnprintf(nullptr, 0, format, copy);
+    va_end(copy);
+    if (len < 0)
+        return len;
+    std::vector<char> text(len + 1);
+    vsnprintf(text.data(), text.size(), format, args);
+    s_threadLog->append(stream, 0, std::string(text.data(), len));
+    return len;
+}
+
+/* printf/fprintf that respect DiagnosticLog::capture */
+int dccPrintf(const char *format, ...)
+{
+    va_list args;
+    va_start(args, format);
+    int res = vdccFprintf(stdout, format, args);
+    va_end(args);
+    return res;
+}
+
+int dccFprintf(FILE *stream, const char *format, ...)
+{
+    va_list args;
+    va_start(args, format);
+    int res = vdccFprintf(stream, format, args);
     va_end(args);
+    return res;
 }
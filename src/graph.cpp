@@ -171,14 +171,10 @@ void Function::markImpure()
         //WARNING: Case entries are held in symbol table !
         assert(Project::get()->validSymIdx(icod.ll()->caseEntry));
         const SYM &psym(Project::get()->getSymByIdx(icod.ll()->caseEntry));
-        for (int c = (int)psym.label; c < (int)psym.label+psym.size; c++)
+        if ((psym.size > 0) and prog.map.any(psym.label, psym.size, BM_CODE))
         {
-            if (BITMAP(c, BM_CODE))
-            {
-                icod.ll()->setFlags(IMPURE);
-                flg |= IMPURE;
-                break;
-            }
+            icod.ll()->setFlags(IMPURE);
+            flg |= IMPURE;
         }
     }
 
@@ -189,11 +185,10 @@ void Function::markImpure()
  ****************************************************************************/
 void Function::freeCFG()
 {
-    for(auto p : m_ip_to_bb)
-    {
-        delete p.second;
-    }
     m_ip_to_bb.clear();
+    m_actual_cfg.clear();
+    m_dfsLast.clear();
+    m_arena.cfgBlocks.release();
 }
 
 
@@ -241,11 +236,8 @@ void Function::compressCFG()
         {
             if (entry_node)	/* Init it misses out on */
                 pBB->index = UN_INIT;
-            else
-            {
-                delete pBB;
+            else        /* unreachable, the BB itself stays in m_arena */
                 stats.numBBaft--;
-            }
         }
         else
         {
@@ -322,7 +314,7 @@ void BB::mergeFallThrough( CIcodeRec &Icode)
     BB *	pChild;
     if (nullptr==this)
     {
-        printf("mergeFallThrough on empty BB!\n");
+        dccPrintf("mergeFallThrough on empty BB!\n");
     }
     while (nodeType == FALL_NODE or nodeType == ONE_BRANCH)
     {
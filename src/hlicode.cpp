@@ -38,7 +38,7 @@ void ICODE::newCallHl()
         hlU()->call.args->cb = hl()->call.proc->cbParam;
     else
     {
-        printf("Function with no cb set, and no valid oper.call.proc , probaby indirect call\n");
+        dccPrintf("Function with no cb set, and no valid oper.call.proc , probaby indirect call\n");
         hl()->call.args->cb = 0;
     }
 }
@@ -108,15 +108,11 @@ HLTYPE LLInst::createCall()
     res.call.proc = src().proc.proc;
     res.call.args = new STKFRAME;
 
-    if (src().proc.cb != 0)
-        res.call.args->cb = src().proc.cb;
-    else if(res.call.proc)
-        res.call.args->cb =res.call.proc->cbParam;
-    else
-    {
-        printf("Function with no cb set, and no valid oper.call.proc , probaby indirect call\n");
-        res.call.args->cb = 0;
-    }
+    /* when the call site does not give the size, Function::highLevelGen
+     * takes it from the callee */
+    res.call.args->cb = src().proc.cb;
+    if ((src().proc.cb == 0) and (res.call.proc == nullptr))
+        dccPrintf("Function with no cb set, and no valid oper.call.proc , probaby indirect call\n");
     return res;
 }
 #if 0
@@ -333,7 +329,7 @@ void Function::highLevelGen()
             }
         if(ll->getOpcode()==iPUSH) {
             if(ll->testFlags(I)) {
-                lhs = new Constant(src_ll->opz,src_ll->byteWidth());
+                lhs = Constant::Create(src_ll->opz,src_ll->byteWidth());
             }
 //            lhs = AstIdent::id (*pIcode->ll(), DST, this, i, *pIcode, NONE);
         }
@@ -355,10 +351,17 @@ void Function::highLevelGen()
             case iCALLF:
                 pIcode->type = HIGH_LEVEL_ICODE;
                 pIcode->hl( ll->createCall() );
+                if ((ll->src().proc.cb == 0) and ll->src().proc.proc)
+                {
+                    if (m_deferred)
+                        m_deferred->calls.push_back(pIcode);
+                    else
+                        pIcode->hlU()->call.args->cb = ll->src().proc.proc->cbParam;
+                }
                 break;
 
             case iDEC:
-                rhs = new BinaryOperator(SUB,lhs, new Constant(1, 2));
+                rhs = new BinaryOperator(SUB,lhs, Constant::Create(1, 2));
                 pIcode->setAsgn(lhs, rhs);
                 break;
 
@@ -380,7 +383,7 @@ void Function::highLevelGen()
                 break;
 
             case iINC:
-                rhs = new BinaryOperator(ADD,lhs, new Constant(1, 2));
+                rhs = new BinaryOperator(ADD,lhs, Constant::Create(1, 2));
                 pIcode->setAsgn(lhs, rhs);
                 break;
 
@@ -504,7 +507,7 @@ QString writeJcond (const HLTYPE &h, Function * pProc, int *numLoc)
     Expr *inverted=h.expr()->inverse();
     //inverseCondOp (&h.exp);
     QString inverted_form = inverted->walkCondExpr (pProc, numLoc);
-    delete inverted;
+    Expr::destroy(inverted);
 
     return QString("if %1 {\n").arg(inverted_form);
 }
@@ -4,7 +4,7 @@
 void HLTYPE::replaceExpr(Expr *e)
 {
     assert(e);
-    delete exp.v;
+    Expr::destroy(exp.v);
     exp.v=e;
 }
 
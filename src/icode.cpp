@@ -14,6 +14,18 @@ ICODE::TypeAndValidFilter<HIGH_LEVEL_ICODE> ICODE::select_valid_high_level;
 CIcodeRec::CIcodeRec()
 {
 }
+CIcodeRec::CIcodeRec(const CIcodeRec &other) : entries(other.entries)
+{
+    rebuildLabelIndex();
+}
+CIcodeRec &CIcodeRec::operator=(const CIcodeRec &other)
+{
+    if(this==&other)
+        return *this;
+    entries = other.entries;
+    rebuildLabelIndex();
+    return *this;
+}
 
 /* Copies the icode that is pointed to by pIcode to the icode array.
  * If there is need to allocate extra memory, it is done so, and
@@ -21,8 +33,24 @@ CIcodeRec::CIcodeRec()
 ICODE * CIcodeRec::addIcode(ICODE *pIcode)
 {
     entries.push_back(*pIcode);
-    entries.back().loc_ip = entries.size()-1;
-    return &entries.back();
+    iterator added = std::prev(entries.end());
+    added->loc_ip = entries.size()-1;
+    /* Synthetic instructions may share a label with the instruction they were
+     * created for (translate_DIV), only the first one is recorded */
+    m_labels.emplace(added->ll()->label,added);
+    return &(*added);
+}
+void CIcodeRec::clear()
+{
+    entries.clear();
+    m_labels.clear();
+}
+void CIcodeRec::rebuildLabelIndex()
+{
+    m_labels.clear();
+    m_labels.reserve(entries.size());
+    for(iterator iter=entries.begin(); iter!=entries.end(); ++iter)
+        m_labels.emplace(iter->ll()->label,iter);
 }
 
 void CIcodeRec::SetInBB(rCODE &rang, BB *pnewBB)
@@ -44,21 +72,19 @@ bool CIcodeRec::labelSrch(uint32_t target, uint32_t &pIndex)
 
 bool CIcodeRec::alreadyDecoded(uint32_t target)
 {
-    iICODE location=labelSrch(target);
-    return location!=entries.end();
+    return m_labels.find(target)!=m_labels.end();
 }
 CIcodeRec::iterator CIcodeRec::labelSrch(uint32_t target)
 {
-    return find_if(entries.begin(),entries.end(),[target](ICODE &l) -> bool {
-        return l.ll()->label==target;
-    });
+    auto location = m_labels.find(target);
+    if(location==m_labels.end())
+        return entries.end();
+    return location->second;
 }
 ICODE * CIcodeRec::GetIcode(size_t ip)
 {
     assert(ip<entries.size());
-    iICODE res=entries.begin();
-    advance(res,ip);
-    return &(*res);
+    return &entries[ip];
 }
 
 extern int getNextLabel();
@@ -90,11 +116,10 @@ bool LLOperand::isReg() const
 {
     return (regi>=rAX) and (regi<=rTMP);
 }
-void LLOperand::addProcInformation(int param_count, CConv::Type call_conv)
+void LLOperand::addProcInformation(Function *caller, int param_count, CConv::Type call_conv)
 {
-    proc.proc->cbParam = (int16_t)param_count;
     proc.cb = param_count;
-    proc.proc->callingConv(call_conv);
+    caller->setCallInfo(proc.proc, (int16_t)param_count, call_conv);
 }
 void HLTYPE::setCall(Function *proc)
 {
@@ -112,24 +137,3 @@ void AssignType::lhs(Expr *l)
     assert(dynamic_cast<UnaryOperator *>(l));
     m_lhs=l;
 }
-
-
-LivenessSet &LivenessSet::operator&=(const LivenessSet &other)
-{
-    std::set<eReg> res;
-    std::set_intersection(registers.begin(),registers.end(),
-                          other.registers.begin(),other.registers.end(),
-                          std::inserter(res, res.end()));
-    registers = res;
-    return *this;
-}
-
-LivenessSet &LivenessSet::operator-=(const LivenessSet &other)
-{
-    std::set<eReg> res;
-    std::set_difference(registers.begin(),registers.end(),
-                        other.registers.begin(),other.registers.end(),
-                        std::inserter(res, res.end()));
-    registers = res;
-    return *this;
-}
@@ -19,7 +19,7 @@ using namespace std;
  ****************************************************************************/
 bool Idiom5::match(iICODE pIcode)
 {
-    if(distance(pIcode,m_end)<2)
+    if(std::distance(pIcode,m_end)<2)
         return false;
     m_icodes[0]=pIcode++;
     m_icodes[1]=pIcode++;
@@ -53,7 +53,7 @@ int Idiom5::action()
  ****************************************************************************/
 bool Idiom6::match(iICODE pIcode)
 {
-    if(distance(pIcode,m_end)<2)
+    if(std::distance(pIcode,m_end)<2)
         return false;
     m_icodes[0]=pIcode++;
     m_icodes[1]=pIcode++;
@@ -143,7 +143,7 @@ bool Idiom18::match(iICODE picode)
     switch(m_idiom_type)
     {
         case 0: // global
-            printf("Unsupported idiom18 type at %x : global variable\n",picode->loc_ip);
+            dccPrintf("Unsupported idiom18 type at %x : global variable\n",picode->loc_ip);
             break;
         case 1:  /* register variable */
             /* Check previous instruction for a MOV */
@@ -159,7 +159,7 @@ bool Idiom18::match(iICODE picode)
             }
             break;
         case 3: // indexed
-            printf("Untested idiom18 type: indexed\n");
+            dccPrintf("Untested idiom18 type: indexed\n");
             if ((m_icodes[0]->ll()->src() == m_icodes[1]->ll()->m_dst))
             {
                 return true;
@@ -220,7 +220,7 @@ bool Idiom19::match(iICODE picode)
     }
     else	/* indexed */
     {
-        fprintf(stderr,"idiom19 : Untested type [indexed]\n");
+        dccFprintf(stderr,"idiom19 : Untested type [indexed]\n");
         return true;
 
         /* not supported yet */
@@ -233,7 +233,7 @@ int Idiom19::action()
 
     lhs = AstIdent::id (*m_icodes[0]->ll(), DST, m_func, m_icodes[0], *m_icodes[1], eUSE);
     lhs = UnaryOperator::Create(m_is_dec ? PRE_DEC : PRE_INC, lhs);
-    expr = new BinaryOperator(condOpJCond[m_icodes[1]->ll()->getOpcode() - iJB],lhs, new Constant(0, 2));
+    expr = new BinaryOperator(condOpJCond[m_icodes[1]->ll()->getOpcode() - iJB],lhs, Constant::Create(0, 2));
     m_icodes[1]->setJCond(expr);
     m_icodes[0]->invalidate();
     return 2;
@@ -286,7 +286,7 @@ bool Idiom20::match(iICODE picode)
         type = 2;
     else		/* indexed */
     {
-        printf("idiom20 : Untested type [indexed]\n");
+        dccPrintf("idiom20 : Untested type [indexed]\n");
         type = 3;
         /* not supported yet */ ;
     }
@@ -309,7 +309,7 @@ bool Idiom20::match(iICODE picode)
                 }
                 break;
             case 3:
-                fprintf(stderr,"Test 3 ");
+                dccFprintf(stderr,"Test 3 ");
                 if ((mov_src == ll_dest))
                 {
                     return true;
@@ -19,7 +19,7 @@ using namespace std;
  ****************************************************************************/
 bool Idiom3::match(iICODE picode)
 {
-    if(distance(picode,m_end)<2)
+    if(std::distance(picode,m_end)<2)
         return false;
     m_param_count=0;
     /* Match ADD  SP, immed */
@@ -42,11 +42,11 @@ int Idiom3::action()
 {
     if (m_icodes[0]->ll()->testFlags(I) )
     {
-        m_icodes[0]->ll()->src().addProcInformation(m_param_count,CConv::eCdecl);
+        m_icodes[0]->ll()->src().addProcInformation(m_func,m_param_count,CConv::eCdecl);
     }
     else
     {
-        printf("Indirect call at idiom3\n");
+        dccPrintf("Indirect call at idiom3\n");
     }
     m_icodes[1]->invalidate();
     return 2;
@@ -67,7 +67,7 @@ int Idiom3::action()
  ****************************************************************************/
 bool Idiom17::match(iICODE picode)
 {
-    if(distance(picode,m_end)<2)
+    if(std::distance(picode,m_end)<2)
         return false;
     m_param_count=0; /* Count on # pops */
     m_icodes.clear();
@@ -100,7 +100,7 @@ int Idiom17::action()
 {
     if (m_icodes[0]->ll()->testFlags(I))
     {
-        m_icodes[0]->ll()->src().addProcInformation(m_param_count,CConv::eCdecl);
+        m_icodes[0]->ll()->src().addProcInformation(m_func,m_param_count,CConv::eCdecl);
         for(size_t idx=1; idx<m_icodes.size(); ++idx)
         {
             m_icodes[idx]->invalidate();
@@ -109,7 +109,7 @@ int Idiom17::action()
     // TODO : it's a calculated call
     else
     {
-        printf("Indirect call at idiom17\n");
+        dccPrintf("Indirect call at idiom17\n");
     }
     return m_icodes.size();
 }
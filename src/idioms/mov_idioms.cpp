@@ -26,7 +26,7 @@ using namespace std;
 
 bool Idiom14::match(iICODE pIcode)
 {
-    if(distance(pIcode,m_end)<2)
+    if(std::distance(pIcode,m_end)<2)
         return false;
     m_icodes[0]=pIcode++;
     m_icodes[1]=pIcode++;
@@ -75,7 +75,7 @@ int Idiom14::action()
  ****************************************************************************/
 bool Idiom13::match(iICODE pIcode)
 {
-    if(distance(pIcode,m_end)<2)
+    if(std::distance(pIcode,m_end)<2)
         return false;
     m_icodes[0]=pIcode++;
     m_icodes[1]=pIcode++;
@@ -21,7 +21,7 @@ bool Idiom11::match (iICODE picode)
 {
     //const char *matchstring="(oNEG rH) (oNEG rL) (SBB \rH i0)";
     condId type;          /* type of argument */
-    if(distance(picode,m_end)<3)
+    if(std::distance(picode,m_end)<3)
         return false;
     for(int i=0; i<3; ++i)
         m_icodes[i]=picode++;
@@ -49,7 +49,7 @@ bool Idiom11::match (iICODE picode)
                 return true;
             break;
         default:
-            fprintf(stderr,"Idiom11::match unhandled type %d\n",type);
+            dccFprintf(stderr,"Idiom11::match unhandled type %d\n",type);
     }
     return false;
 }
@@ -80,7 +80,7 @@ int Idiom11::action()
 bool Idiom16::match (iICODE picode)
 {
     //const char *matchstring="(oNEG rR) (oSBB rR rR) (oINC rR)";
-    if(distance(picode,m_end)<3)
+    if(std::distance(picode,m_end)<3)
         return false;
     for(int i=0; i<3; ++i)
         m_icodes[i]=picode++;
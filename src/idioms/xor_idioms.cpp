@@ -21,7 +21,7 @@ using namespace std;
 bool Idiom21::match (iICODE picode)
 {
     LLOperand *dst, *src;
-    if(distance(picode,m_end)<2)
+    if(std::distance(picode,m_end)<2)
         return false;
     m_icodes[0]=picode++;
     m_icodes[1]=picode++;
@@ -46,7 +46,7 @@ int Idiom21::action()
     AstIdent *lhs;
 
     lhs = AstIdent::Long (&m_func->localId, DST, m_icodes[0],HIGH_FIRST, m_icodes[0], eDEF, *m_icodes[1]->ll());
-    rhs = new Constant(m_icodes[1]->ll()->src().getImm2(), 4);
+    rhs = Constant::Create(m_icodes[1]->ll()->src().getImm2(), 4);
     m_icodes[0]->setAsgn(lhs, rhs);
     m_icodes[0]->du.use.reset();		/* clear register used in iXOR */
     m_icodes[1]->invalidate();
@@ -89,7 +89,7 @@ int Idiom7::action()
 {
     Expr *lhs;
     lhs = AstIdent::id (*m_icode->ll(), DST, m_func, m_icode, *m_icode, NONE);
-    m_icode->setAsgn(dynamic_cast<AstIdent *>(lhs), new Constant(0, 2));
+    m_icode->setAsgn(dynamic_cast<AstIdent *>(lhs), Constant::Create(0, 2));
     m_icode->du.use.reset();    /* clear register used in iXOR */
     m_icode->ll()->setFlags(I);
     return 1;
@@ -112,7 +112,7 @@ int Idiom7::action()
  ****************************************************************************/
 bool Idiom10::match(iICODE pIcode)
 {
-    if(distance(pIcode,m_end)<2)
+    if(std::distance(pIcode,m_end)<2)
         return false;
     m_icodes[0]=pIcode++;
     m_icodes[1]=pIcode++;
@@ -44,11 +44,11 @@ bool LivenessSet::testRegAndSubregs(int r) const
 void LivenessSet::postProcessCompositeRegs()
 {
     if(testReg(rAL) and testReg(rAH))
-        registers.insert(rAX);
+        registers |= bit(rAX);
     if(testReg(rCL) and testReg(rCH))
-        registers.insert(rCX);
+        registers |= bit(rCX);
     if(testReg(rDL) and testReg(rDH))
-        registers.insert(rDX);
+        registers |= bit(rDX);
     if(testReg(rBL) and testReg(rBH))
-        registers.insert(rBX);
+        registers |= bit(rBX);
 }
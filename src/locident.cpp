@@ -111,7 +111,7 @@ void LOCAL_ID::flagByteWordId (int off)
     });
     if(found==id_arr.end())
     {
-        printf("No entry to flag as invalid in LOCAL_ID::flagByteWordId \n");
+        dccPrintf("No entry to flag as invalid in LOCAL_ID::flagByteWordId \n");
         return;
     }
     found->illegal = true;
@@ -224,7 +224,7 @@ int LOCAL_ID::newLongGlb(int16_t seg, int16_t offH, int16_t offL,hlType t)
                 (id_arr[idx].id.longGlb.offL == offL))
             return (idx);
     }
-    printf("%d",t);
+    dccPrintf("%d",t);
     /* Not in the table, create new identifier */
     id_arr.emplace_back(t, LONGGLB_TYPE(seg,offH,offL));
     return id_arr.size() - 1;
@@ -317,16 +317,16 @@ int LOCAL_ID::newLong(opLoc sd, iICODE pIcode, hlFirst f, iICODE ix,operDu du, L
             idx = newLongStk(TYPE_LONG_SIGN, pmH->off, pmL->off);
         else if ((pmL->seg == rDS) and (pmL->regi == INDEX_BX))   /* bx */
         {                                       /* glb var indexed on bx */
-            printf("Bx indexed global, BX is an unused parameter to newLongIdx\n");
+            dccPrintf("Bx indexed global, BX is an unused parameter to newLongIdx\n");
             idx = newLongIdx(pmH->segValue, pmH->off, pmL->off,rBX,TYPE_LONG_SIGN);
             pIcode->setRegDU( rBX, eUSE);
         }
         else                                            /* idx <> bp, bx */
-            printf ("long not supported, idx <> bp\n");
+            dccPrintf("long not supported, idx <> bp\n");
     }
 
     else  /* (pm->regi >= INDEXBASE and pm->off = 0) => indexed and no off */
-        printf ("long not supported, idx and no off\n");
+        dccPrintf("long not supported, idx and no off\n");
 
     return idx;
 }
@@ -15,7 +15,12 @@
 #include <cstdio>
 #include <sstream>
 #include <algorithm>
+#include <atomic>
 #include <deque>
+#include <map>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
 
 using namespace std;
 
@@ -26,14 +31,206 @@ static SYM *     lookupAddr (LLOperand *pm, STATE * pstate, int size, uint16_t d
 void    interactDis(Function * initProc, int ic);
 extern uint32_t    SynthLab;
 
-/* Returns the size of the string pointed by sym and delimited by delim.
+/* A change of the global symbol table made while parsing */
+struct SymbolOp
+{
+    enum eKind
+    {
+        LOOKUP,     /* updateGlobSym, from lookupAddr   */
+        SET_VAL,    /* duVal.val = 1                    */
+        DU_FLAGS,   /* duVal.setFlags(flags)            */
+        POINTER,    /* type = TYPE_PTR                  */
+        STRING      /* updateSymType(TYPE_STR, size)    */
+    };
+    eKind       kind;
+    uint32_t    label;
+    int         size;
+    uint16_t    flags;      /* duFlag of LOOKUP, or the DU_FLAGS */
+    bool        segCheck;   /* LOOKUP: flag a new symbol holding a relocated segment SEG_IMMED */
+    SymbolOp(eKind k, uint32_t lab, int sz=0, uint16_t fl=0, bool seg=false) :
+        kind(k),label(lab),size(sz),flags(fl),segCheck(seg)
+    {}
+    void    initNew(SYM &sym) const;
+    void    change(SYM &sym) const;
+    SYM *   apply(SYMTAB &symtab) const;
+};
+
+/* What a worker of the concurrent parser (-j) found out about one procedure.
+ * The project is only read while the workers run: bitmap bits, symbols and
+ * calls are kept here, applied to the project after each round, and replayed
+ * in call order once all procedures are parsed. */
+struct ParseShard
+{
+    struct Call
+    {
+        ICODE *     insn;
+        uint32_t    target;
+        bool        indirect;
+        STATE       state;          /* entry state of a new callee          */
+        Function *  callee;         /* nullptr until the end of the round   */
+    };
+    struct Event
+    {
+        enum eKind { SYMBOL, SYNTH_LABEL, CALL, INTERACT, FATAL, TRACE };
+        eKind       kind;
+        size_t      logPos;         /* diagnostics printed before the event */
+        size_t      index;          /* symbolOps or calls index, icode index, exit code or IP */
+    };
+    std::vector<Event>      events;
+    std::vector<SymbolOp>   symbolOps;
+    std::vector<Call>       calls;
+    std::map<uint32_t,SYM>  symbols;        /* copies of the symbols used so far  */
+    MemoryMap               map;            /* bits set in prog.map               */
+    uint32_t                nextSynth=SYNTHESIZED_MIN; /* temporary synthetic labels */
+    std::vector<uint32_t>   synthLabels;    /* their final values                 */
+    DiagnosticLog           log;
+
+    void add(Event::eKind kind, size_t index)
+    {
+        events.push_back(Event{kind,log.size(),index});
+    }
+    SYM *apply(const SymbolOp &op);
+};
+static thread_local ParseShard *s_shard = nullptr;  /* set on parser workers */
+
+/* Sets up a symbol that LOOKUP has just created */
+void SymbolOp::initNew(SYM &sym) const
+{
+    PROG &prog(Project::get()->prog);
+    uint32_t operand = label;
+    if (not segCheck)
+        return;
+    if (size == 4)
+        operand += 2;   /* High uint16_t */
+    if (prog.isRelocated(operand))
+        sym.flg = SEG_IMMED;
+}
+
+void SymbolOp::change(SYM &sym) const
+{
+    switch (kind)
+    {
+        case LOOKUP:
+            if (sym.size < size)
+                sym.size = size;
+            break;
+        case SET_VAL:
+            sym.duVal.val = 1;
+            break;
+        case DU_FLAGS:
+            sym.duVal.setFlags(flags);
+            break;
+        case POINTER:
+            sym.type = TYPE_PTR;
+            break;
+        case STRING:
+            sym.type = TYPE_STR;
+            if (size != 0)
+                sym.size = size;
+            break;
+    }
+}
+
+SYM *SymbolOp::apply(SYMTAB &symtab) const
+{
+    if (kind == LOOKUP)
+    {
+        bool created_new=false;
+        SYM *psym = symtab.updateGlobSym(label, size, flags, created_new);
+        if (created_new)
+            initNew(*psym);
+        return psym;
+    }
+    auto iter = symtab.findByLabel(label);
+    if (iter == symtab.end())
+        return nullptr;
+    change(*iter);
+    return &(*iter);
+}
+
+/* Same as op.apply(), on the procedure's copies of the symbols */
+SYM *ParseShard::apply(const SymbolOp &op)
+{
+    symbolOps.push_back(op);
+    add(Event::SYMBOL, symbolOps.size()-1);
+    auto iter = symbols.find(op.label);
+    if (iter == symbols.end())
+    {
+        SYMTAB &symtab(Project::get()->symtab);
+        auto global = symtab.findByLabel(op.label);
+        if (global != symtab.end())
+            iter = symbols.emplace(op.label,*global).first;
+        else if (op.kind == SymbolOp::LOOKUP)
+        {
+            iter = symbols.emplace(op.label,SYMTAB::newGlobSym(op.label, op.size, op.flags)).first;
+            op.initNew(iter->second);
+            return &iter->second;
+        }
+        else
+            return nullptr;
+    }
+    op.change(iter->second);
+    return &iter->second;
+}
+
+/* Performs op on the project's symbol table, or on a parser worker on the
+ * procedure's copies of the symbols */
+static SYM *changeSymbols(const SymbolOp &op)
+{
+    if (s_shard)
+        return s_shard->apply(op);
+    return op.apply(Project::get()->symtab);
+}
+
+/* Value kept in caseEntry of SYM_USE/SYM_DEF icodes: the symbol's index. A
+ * parser worker stores the label, which becomes the index at the end. */
+static int symbolIndex(const SYM *psym)
+{
+    if (s_shard)
+        return psym->label;
+    return distance<const SYM *>(&Project::get()->symtab[0],psym);
+}
+
+/* Synthetic icodes are labelled from SynthLab on. A parser worker uses
+ * temporary labels, which are renumbered in call order at the end. */
+static uint32_t newSynthLabel()
+{
+    if (s_shard == nullptr)
+        return SynthLab++;
+    s_shard->add(ParseShard::Event::SYNTH_LABEL, 0);
+    return s_shard->nextSynth++;
+}
+
+/* Verbose listing of the start of a path of proc's parse. A parser worker
+ * leaves it to the replay, when the names of new procedures are known. */
+static void traceParse(Function *proc, uint32_t ip)
+{
+    if (s_shard)
+    {
+        s_shard->add(ParseShard::Event::TRACE, ip);
+        return;
+    }
+    qDebug() << "Parsing proc" << proc->name << "at"<< QString::number(ip,16).toUpper();
+}
+
+/* BITMAP, including the bits a parser worker has set itself */
+static bool testBits(uint32_t i, int type)
+{
+    PROG &prog(Project::get()->prog);
+    if (BITMAP(i, type))
+        return true;
+    return s_shard and s_shard->map.test(i, type);
+}
+
+/* Returns the size of the string at image offset off and delimited by delim.
  * Size includes delimiter.     */
-int strSize (const uint8_t *sym, char delim)
+int strSize (uint32_t off, char delim)
 {
     PROG &prog(Project::get()->prog);
-    int till_end = sym-prog.image();
-    const uint8_t *end_ptr=std::find(sym,sym+(prog.cbImage-(till_end)),delim);
-    return end_ptr-sym+1;
+    uint32_t end = off;
+    while (end < (uint32_t)prog.cbImage and prog.byte(end) != (uint8_t)delim)
+        ++end;
+    return end-off+1;
 }
 
 ICODE * Function::translate_DIV(LLInst *ll, ICODE &_Icode)
@@ -70,7 +267,7 @@ ICODE * Function::translate_DIV(LLInst *ll, ICODE &_Icode)
     eIcode.ll()->set(iMOD,ll->getFlag() | SYNTHETIC  | IM_TMP_DST);
     eIcode.ll()->replaceSrc(_Icode.ll()->src());
     eIcode.du = _Icode.du;
-    eIcode.ll()->label = SynthLab++;
+    eIcode.ll()->label = newSynthLabel();
     return Icode.addIcode(&eIcode);
 }
 
@@ -109,34 +306,370 @@ ICODE *Function::translate_XCHG(LLInst *ll,ICODE &r_Icode)
     }
     eIcode.ll()->replaceSrc(rTMP);
     eIcode.setRegDU( rTMP, eUSE);
-    eIcode.ll()->label = SynthLab++;
+    eIcode.ll()->label = newSynthLabel();
     return Icode.addIcode(&eIcode);
 }
 
+/* One path of the recursive descent parse: decodes instructions from
+ * state->IP onwards until the path ends. Conditional jumps, switch entries
+ * and calls to new procedures start nested paths; the path is then suspended
+ * with resume telling where to continue once the nested path is done. */
+struct ParseTrace
+{
+    enum eResume
+    {
+        START,          /* nothing parsed yet                                 */
+        JCOND_TAKEN,    /* fall through path parsed, follow the jump          */
+        NEXT_CASE,      /* switch entry parsed, mark it and parse the next one */
+        CALL_RETURN     /* new callee parsed, restore the caller's segments   */
+    };
+    Function *  proc;
+    STATE *     state;          /* ownState, or the caller's state for a callee */
+    STATE       ownState;
+    eResume     resume=START;
+    /* JCOND_TAKEN */
+    int         jumpIdx=0;      /* index of the conditional jump        */
+    ICODE *     prev=nullptr;   /* icode before the conditional jump    */
+    bool        fBranch=false;
+    /* NEXT_CASE */
+    ICODE *     switchInsn=nullptr;
+    std::vector<uint32_t> caseTargets;
+    size_t      nextCase=0;
+    iICODE      lastInsn;       /* last icode before the current entry  */
+    /* CALL_RETURN */
+    STATE       callerState;
+};
+
+/* Explicit stack of parse paths; the innermost path is at the back. Paths are
+ * resumed in the order a recursive depth first search would return to them,
+ * so icodes, procedures and their names keep that order, while the depth of
+ * the parse is bounded by memory instead of the C++ stack. */
+class ParseWorklist
+{
+    std::deque<ParseTrace>  m_paths;    /* deque: pushing keeps references to suspended paths valid */
+    CALL_GRAPH *            m_callGraph;
+public:
+    explicit ParseWorklist(CALL_GRAPH *callGraph) : m_callGraph(callGraph) {}
+    CALL_GRAPH *callGraph() const { return m_callGraph; }
+    /// Starts a path of proc; with state==nullptr the path gets its own state
+    ParseTrace &push(Function *proc, STATE *state)
+    {
+        m_paths.emplace_back();
+        ParseTrace &res(m_paths.back());
+        res.proc = proc;
+        res.state = state ? state : &res.ownState;
+        return res;
+    }
+    /// true if trace has started a nested path and has to wait for it
+    bool waiting(const ParseTrace &trace) const { return &m_paths.back() != &trace; }
+    /// Parses the targets of a switch, each with a copy of trace's state
+    void followCases(ParseTrace &trace, ICODE &switchInsn, std::vector<uint32_t> &&targets)
+    {
+        if (targets.empty())
+            return;
+        trace.resume = ParseTrace::NEXT_CASE;
+        trace.switchInsn = &switchInsn;
+        trace.caseTargets = std::move(targets);
+        trace.nextCase = 0;
+        startCase(trace);
+    }
+    void startCase(ParseTrace &trace)
+    {
+        trace.lastInsn = (++trace.proc->Icode.entries.rbegin()).base();
+        ParseTrace &entry(push(trace.proc,nullptr));
+        entry.ownState = *trace.state;
+        entry.ownState.IP = trace.caseTargets[trace.nextCase];
+    }
+    void run()
+    {
+        while (not m_paths.empty())
+        {
+            ParseTrace &trace(m_paths.back());
+            if (trace.proc->parsePath(*this, trace))
+                m_paths.pop_back();
+        }
+    }
+};
+
 /** FollowCtrl - Given an initial procedure, state information and symbol table
  * builds a list of procedures reachable from the initial procedure
  * using a depth first search.     */
 void Function::FollowCtrl(CALL_GRAPH * pcallGraph, STATE *pstate)
+{
+    ParseWorklist work(pcallGraph);
+    work.push(this,pstate);
+    work.run();
+}
+
+/* Runs the search of FollowCtrl on option.Jobs threads, for -j 2 or more; a
+ * plain run uses FollowCtrl itself. Procedures are parsed in rounds: the first
+ * round parses the initial procedure, every later one the procedures called
+ * for the first time in the round before. Between rounds the
+ * workers' effects are applied to the project; at the end they are replayed in
+ * the order of a depth first search over the calls, which gives the procedure
+ * list, names, synthetic labels, symbols, call graph and diagnostics the order
+ * of FollowCtrl's search.
+ * The procedures of a round are parsed independently of each other, which is
+ * where this search differs from FollowCtrl's:
+ *  - after a call to a new procedure the caller goes on with its own state,
+ *    not with the state the callee's parse ended with;
+ *  - a new procedure is entered with the state of its first call in round
+ *    order, not of its first call in the depth first search;
+ *  - a procedure only sees the bitmap bits (prog.map) of the rounds before
+ *    and its own, not those of the other procedures of its round.
+ * The same rounds are parsed for any number of threads, so the result does
+ * not depend on it. jobs_regression.sh checks that the regression inputs
+ * decompile the same with FollowCtrl. */
+class ConcurrentParser
+{
+    Project &   m_project;
+    std::unordered_map<Function *,ParseShard>       m_shards;
+    std::unordered_map<Function *,DiagnosticLog>    m_libCheckLogs; /* output of LibCheck for new procs */
+public:
+    explicit ConcurrentParser(Project &project) : m_project(project) {}
+    void run(Function *start)
+    {
+        SYMTAB initialSymbols = m_project.symtab;
+        std::vector<Function *> round {start};
+        while (not round.empty())
+        {
+            parseRound(round);
+            round = endRound(round);
+        }
+        m_project.symtab = initialSymbols;
+        replay(start);
+    }
+private:
+    void parseRound(const std::vector<Function *> &round)
+    {
+        std::atomic<size_t> next(0);
+        auto worker = [this,&round,&next]()
+        {
+            for (size_t idx = next++; idx < round.size(); idx = next++)
+            {
+                Function *f = round[idx];
+                ParseShard &shard(m_shards.at(f));
+                s_shard = &shard;
+                DiagnosticLog::capture(&shard.log);
+                STATE state = f->state;
+                f->FollowCtrl(m_project.callGraph, &state);
+                DiagnosticLog::capture(nullptr);
+                s_shard = nullptr;
+            }
+        };
+        for (Function *f : round)
+            m_shards[f].map.reset(m_project.prog.cbImage);
+        if (round.size() == 1)
+        {
+            worker();
+            return;
+        }
+        std::vector<std::thread> threads;
+        for (size_t i = 0; i < std::min<size_t>(option.Jobs,round.size()); ++i)
+            threads.emplace_back(worker);
+        for (std::thread &t : threads)
+            t.join();
+    }
+    /* Merges the round's bitmaps and symbols into the project and creates the
+     * procedures called for the first time, which are returned */
+    std::vector<Function *> endRound(const std::vector<Function *> &round)
+    {
+        PROG &prog(m_project.prog);
+        std::vector<Function *> res;
+        for (Function *f : round)
+        {
+            ParseShard &shard(m_shards.at(f));
+            for (const MemoryMap::Region &r : shard.map.regions(BM_IMPURE))
+            {
+                prog.map.set(r.start, r.end - r.start, r.type);
+                if (r.type & BM_DATA)
+                    m_project.decoded.invalidate(r.start, r.end - r.start);
+            }
+            shard.map.reset(0);
+            shard.symbols.clear();
+            for (const SymbolOp &op : shard.symbolOps)
+                op.apply(m_project.symtab);
+            for (ParseShard::Call &call : shard.calls)
+            {
+                if (call.callee)
+                    continue;
+                ilFunction iter = m_project.findByEntry(call.target);
+                if (not m_project.valid(iter))
+                {
+                    iter = m_project.createFunction(0,"",call.target);
+                    Function &x(*iter);
+                    DiagnosticLog::capture(&m_libCheckLogs[&x]);
+                    LibCheck(x);
+                    DiagnosticLog::capture(nullptr);
+                    if (not x.isLibrary())
+                    {
+                        if (call.indirect)
+                            x.flg |= PROC_ICALL;
+                        x.depth = x.depth + 1;
+                        x.flg |= TERMINATES;
+                        x.state = call.state;
+                        res.push_back(&x);
+                    }
+                }
+                call.callee = &(*iter);
+                call.insn->ll()->src().proc.proc = call.callee;
+            }
+        }
+        return res;
+    }
+    /* Replays the shards depth first, entering a callee at its first call */
+    void replay(Function *start)
+    {
+        PROG &prog(m_project.prog);
+        std::vector<Function *> order {start};
+        std::unordered_set<Function *> visited {start};
+        std::vector<std::pair<Function *,size_t>> stack; /* proc, next event */
+        stack.emplace_back(start,0);
+        while (not stack.empty())
+        {
+            Function *proc = stack.back().first;
+            ParseShard &shard(m_shards.at(proc));
+            if (stack.back().second == shard.events.size())
+            {
+                shard.log.replay();
+                stack.pop_back();
+                continue;
+            }
+            const ParseShard::Event &e(shard.events[stack.back().second++]);
+            shard.log.replayUpTo(e.logPos);
+            switch (e.kind)
+            {
+                case ParseShard::Event::SYMBOL:
+                    shard.symbolOps[e.index].apply(m_project.symtab);
+                    break;
+                case ParseShard::Event::SYNTH_LABEL:
+                    shard.synthLabels.push_back(SynthLab++);
+                    break;
+                case ParseShard::Event::INTERACT:
+                    interactDis(proc, e.index);
+                    break;
+                case ParseShard::Event::FATAL:
+                    exit(int(e.index));
+                case ParseShard::Event::TRACE:
+                    traceParse(proc, e.index);
+                    break;
+                case ParseShard::Event::CALL:
+                {
+                    Function *callee = shard.calls[e.index].callee;
+                    bool parsed = (m_shards.find(callee) != m_shards.end());
+                    bool first = visited.insert(callee).second;
+                    if (first)
+                    {
+                        order.push_back(callee);
+                        auto created = m_libCheckLogs.find(callee);
+                        if (created != m_libCheckLogs.end())
+                            created->second.replay();
+                        if (parsed and callee->name.isEmpty())     /* Don't overwrite existing name */
+                            callee->name = QString("proc_%1_%2").arg(callee->procEntry ,6,16,QChar('0')).arg(++prog.cProcs);
+                    }
+                    m_project.callGraph->insertCallGraph(proc, m_project.funcIter(callee));
+                    if (first and parsed)
+                        stack.emplace_back(callee,0);
+                    break;
+                }
+            }
+        }
+        /* Procedures in the order they were first called */
+        for (Function *f : order)
+            m_project.pProcList.splice(m_project.pProcList.end(), m_project.pProcList, m_project.funcIter(f));
+        for (std::pair<Function * const,ParseShard> &entry : m_shards)
+        {
+            ParseShard &shard(entry.second);
+            for (ICODE &ic : entry.first->Icode.entries)
+            {
+                LLInst *ll = ic.ll();
+                if (ll->label >= SYNTHESIZED_MIN)
+                    ll->label = shard.synthLabels[ll->label-SYNTHESIZED_MIN];
+                for (uint32_t &lab : ll->caseTbl2)
+                    if (lab >= SYNTHESIZED_MIN)
+                        lab = shard.synthLabels[lab-SYNTHESIZED_MIN];
+                if (ll->testFlags(SYM_USE | SYM_DEF) and not ll->testFlags(CASE))
+                    ll->caseEntry = m_project.getSymIdxByAddr(ll->caseEntry);
+            }
+            entry.first->Icode.rebuildLabelIndex();
+        }
+    }
+};
+
+/** FollowCtrlConcurrent - builds the list of procedures reachable from this
+ * one, parsing them on option.Jobs threads. The result is the same for any
+ * number of threads; see ConcurrentParser for how it differs from FollowCtrl. */
+void Function::FollowCtrlConcurrent(STATE *pstate)
+{
+    state = *pstate;
+    ConcurrentParser(*Project::get()).run(this);
+}
+
+/* Parses one path of FollowCtrl's search. Returns false when the path has
+ * started a nested one and waits for it on the worklist, true when it is done. */
+bool Function::parsePath(ParseWorklist &work, ParseTrace &trace)
 {
     PROG &prog(Project::get()->prog);
     ICODE   _Icode, *pIcode;     /* This gets copied to pProc->Icode[] later */
     SYM *    psym;
     uint32_t   offset;
-    eErrorId err;
+    eErrorId err = NO_ERR;
     bool   done = false;
-    SYMTAB &global_symbol_table(Project::get()->symtab);
-    if (name.contains("chkstk"))
+    STATE *pstate = trace.state;
+    switch (trace.resume)
     {
-        // Danger! Dcc will likely fall over in this code.
-        // So we act as though we have done with this proc
-        //		pProc->flg &= ~TERMINATES;			// Not sure about this
-        // And mark it as a library function, so structure() won't choke on it
-        flg |= PROC_ISLIB;
-        return;
-    }
-    if (option.VeryVerbose)
-    {
-        qDebug() << "Parsing proc" << name << "at"<< QString::number(pstate->IP,16).toUpper();
+        case ParseTrace::START:
+            if (name.contains("chkstk"))
+            {
+                // Danger! Dcc will likely fall over in this code.
+                // So we act as though we have done with this proc
+                //		pProc->flg &= ~TERMINATES;			// Not sure about this
+                // And mark it as a library function, so structure() won't choke on it
+                flg |= PROC_ISLIB;
+                return true;
+            }
+            if (option.VeryVerbose)
+                traceParse(this, pstate->IP);
+            break;
+
+        case ParseTrace::JCOND_TAKEN:
+            trace.resume = ParseTrace::START;
+            if (trace.fBranch)                /* Do branching code */
+            {
+                pstate->JCond.regi = trace.prev->ll()->m_dst.regi;
+            }
+            /* Next icode. Note: not the same as GetLastIcode() because of the
+             * fall through path parsed in between */
+            pIcode = Icode.GetIcode(trace.jumpIdx);
+            done = process_JMP (*pIcode, trace, work);
+            if (work.waiting(trace))
+                return false;
+            break;
+
+        case ParseTrace::NEXT_CASE:
+        {
+            ++trace.lastInsn; // the first instruction added by the entry's path
+            trace.lastInsn->ll()->caseEntry = trace.nextCase++;
+            trace.lastInsn->ll()->setFlags(CASE);
+            trace.switchInsn->ll()->caseTbl2.push_back( trace.lastInsn->ll()->GetLlLabel() );
+            if (trace.nextCase < trace.caseTargets.size())
+            {
+                work.startCase(trace);
+                return false;
+            }
+            return true;
+        }
+        case ParseTrace::CALL_RETURN:
+            trace.resume = ParseTrace::START;
+            /* Restore segment registers & IP from callerState */
+            pstate->IP = trace.callerState.IP;
+            pstate->setState( rCS, trace.callerState.r[rCS]);
+            pstate->setState( rDS, trace.callerState.r[rDS]);
+            pstate->setState( rES, trace.callerState.r[rES]);
+            pstate->setState( rSS, trace.callerState.r[rSS]);
+            pstate->kill(rBX);
+            pstate->kill(rCX);
+            break;
     }
 
     while (not done )
@@ -160,7 +693,7 @@ void Function::FollowCtrl(CALL_GRAPH * pcallGraph, STATE *pstate)
             _Icode.type = LOW_LEVEL_ICODE;
             ll->set(iJMP,I | SYNTHETIC | NO_OPS);
             ll->replaceSrc(LLOperand::CreateImm2(labLoc->ll()->GetLlLabel()));
-            ll->label = SynthLab++;
+            ll->label = newSynthLabel();
         }
 
         /* Copy Icode to Proc */
@@ -180,9 +713,9 @@ void Function::FollowCtrl(CALL_GRAPH * pcallGraph, STATE *pstate)
             case iJO:   case iJNO:      case iJP:   case iJNP:
             case iJCXZ:
             {
-                STATE   StCopy;
                 int     ip      = Icode.entries.size()-1;	/* Index of this jump */
-                ICODE  &prev(*(++Icode.entries.rbegin())); /* Previous icode */
+                /* Previous icode, none if the jump is the first of the procedure */
+                ICODE  *prev = (ip > 0) ? &*(++Icode.entries.rbegin()) : nullptr;
                 bool   fBranch = false;
 
                 pstate->JCond.regi = 0;
@@ -190,39 +723,42 @@ void Function::FollowCtrl(CALL_GRAPH * pcallGraph, STATE *pstate)
                 /* This sets up range check for indexed JMPs hopefully
              * Handles JA/JAE for fall through and JB/JBE on branch
             */
-                if (ip > 0 and prev.ll()->getOpcode() == iCMP and (prev.ll()->testFlags(I)))
+                if (prev and prev->ll()->getOpcode() == iCMP and (prev->ll()->testFlags(I)))
                 {
-                    pstate->JCond.immed = (int16_t)prev.ll()->src().getImm2();
+                    pstate->JCond.immed = (int16_t)prev->ll()->src().getImm2();
                     if (ll->match(iJA) or ll->match(iJBE) )
                         pstate->JCond.immed++;
                     if (ll->getOpcode() == iJAE or ll->getOpcode() == iJA)
-                        pstate->JCond.regi = prev.ll()->m_dst.regi;
+                        pstate->JCond.regi = prev->ll()->m_dst.regi;
                     fBranch = (bool) (ll->getOpcode() == iJB or ll->getOpcode() == iJBE);
                 }
-                StCopy = *pstate;
-
-                /* Straight line code */
-                this->FollowCtrl (pcallGraph, &StCopy); // recurrent ?
 
-                if (fBranch)                /* Do branching code */
-                {
-                    pstate->JCond.regi = prev.ll()->m_dst.regi;
-                }
-                /* Next icode. Note: not the same as GetLastIcode() because of the call
-                                to FollowCtrl() */
-                pIcode = Icode.GetIcode(ip);
-            }		/* Fall through to do the jump path */
+                /* Straight line code first, the jump path when it is done */
+                trace.resume = ParseTrace::JCOND_TAKEN;
+                trace.jumpIdx = ip;
+                trace.prev = prev;
+                trace.fBranch = fBranch;
+                work.push(this,nullptr).ownState = *pstate;
+                return false;
+            }
 
                 /*** Jumps ***/
             case iJMP:
             case iJMPF: /* Returns true if we've run into a loop */
-                done = process_JMP (*pIcode, pstate, pcallGraph);
+                done = process_JMP (*pIcode, trace, work);
+                if (work.waiting(trace))
+                    return false;
                 break;
 
                 /*** Calls ***/
             case iCALL:
             case iCALLF:
-                done = process_CALL (*pIcode, pcallGraph, pstate);
+                done = process_CALL (*pIcode, trace, work);
+                if (work.waiting(trace))
+                {
+                    trace.resume = ParseTrace::CALL_RETURN;
+                    return false;
+                }
                 pstate->kill(rBX);
                 pstate->kill(rCX);
                 break;
@@ -259,9 +795,9 @@ void Function::FollowCtrl(CALL_GRAPH * pcallGraph, STATE *pstate)
                             operand = ((uint32_t)(uint16_t)pstate->r[rDS]<<4) +
                                       (uint32_t)(uint16_t)pstate->r[rDX];
                             size = prog.fCOM ?
-                                       strSize (&prog.image()[operand], '$') :
-                                       strSize (&prog.image()[operand], '$'); // + 0x100
-                            global_symbol_table.updateSymType (operand, TypeContainer(TYPE_STR, size));
+                                       strSize (operand, '$') :
+                                       strSize (operand, '$'); // + 0x100
+                            changeSymbols(SymbolOp(SymbolOp::STRING, operand, size));
                         }
                 }
                 else if ((ll->src().getImm2() == 0x2F) and (pstate->f[rAH]))
@@ -302,11 +838,11 @@ void Function::FollowCtrl(CALL_GRAPH * pcallGraph, STATE *pstate)
                 if ((psym = lookupAddr(&ll->src(), pstate, 4, eDuVal::USE))
                         /* and (Icode.ll()->flg & SEG_IMMED) */ )
                 {
-                    offset = LH(&prog.image()[psym->label]);
+                    offset = prog.word(psym->label);
                     pstate->setState( (ll->getOpcode() == iLDS)? rDS: rES,
-                                      LH(&prog.image()[psym->label + 2]));
+                                      prog.word(psym->label + 2));
                     pstate->setState( ll->m_dst.regi, (int16_t)offset);
-                    psym->type = TYPE_PTR;
+                    changeSymbols(SymbolOp(SymbolOp::POINTER, psym->label));
                 }
                 break;
         }
@@ -315,16 +851,33 @@ void Function::FollowCtrl(CALL_GRAPH * pcallGraph, STATE *pstate)
     if (err) {
         this->flg &= ~TERMINATES;
 
+        /* A parser worker must not exit, the program ends when the error is
+         * replayed */
         if (err == INVALID_386OP or err == INVALID_OPCODE)
         {
-            fatalError(err, prog.image()[_Icode.ll()->label], _Icode.ll()->label);
+            if (s_shard)
+            {
+                reportError(err, prog.byte(_Icode.ll()->label), _Icode.ll()->label);
+                s_shard->add(ParseShard::Event::FATAL, err);
+            }
+            else
+                fatalError(err, prog.byte(_Icode.ll()->label), _Icode.ll()->label);
             this->flg |= PROC_BADINST;
         }
         else if (err == IP_OUT_OF_RANGE)
-            fatalError (err, _Icode.ll()->label);
+        {
+            if (s_shard)
+            {
+                reportError(err, _Icode.ll()->label);
+                s_shard->add(ParseShard::Event::FATAL, err);
+            }
+            else
+                fatalError (err, _Icode.ll()->label);
+        }
         else
             reportError(err, _Icode.ll()->label);
     }
+    return true;
 }
 
 /* Firstly look for a leading range check of the form:-
@@ -343,34 +896,24 @@ void Function::extractJumpTableRange(ICODE& pIcode, STATE *pstate, JumpTable &ta
 }
 
 /* process_JMP - Handles JMPs, returns true if we should end recursion  */
-bool Function::followAllTableEntries(JumpTable &table, uint32_t cs, ICODE& pIcode, CALL_GRAPH* pcallGraph, STATE *pstate)
+bool Function::followAllTableEntries(JumpTable &table, uint32_t cs, ICODE& pIcode, ParseTrace &trace, ParseWorklist &work)
 {
     PROG &prog(Project::get()->prog);
-    STATE   StCopy;
 
     setBits(BM_DATA, table.start, table.size()*table.entrySize());
 
     pIcode.ll()->setFlags(SWITCH);
     pIcode.ll()->caseTbl2.resize( table.size() );
     assert(pIcode.ll()->caseTbl2.size()<512);
-    uint32_t k=0;
+    std::vector<uint32_t> targets;
     for (size_t i = table.start; i < table.finish; i += 2)
-    {
-        StCopy = *pstate;
-        StCopy.IP = cs + LH(&prog.image()[i]);
-        iICODE last_current_insn = (++Icode.entries.rbegin()).base();
-
-        FollowCtrl (pcallGraph, &StCopy);
-
-        ++last_current_insn; // incremented here because FollowCtrl might have adde more instructions after the Jmp
-        last_current_insn->ll()->caseEntry = k++;
-        last_current_insn->ll()->setFlags(CASE);
-        pIcode.ll()->caseTbl2.push_back( last_current_insn->ll()->GetLlLabel() );
-    }
+        targets.push_back(cs + prog.word(i));
+    work.followCases(trace, pIcode, std::move(targets));
     return true;
 }
-bool Function::decodeIndirectJMP(ICODE & pIcode, STATE *pstate, CALL_GRAPH * pcallGraph)
+bool Function::decodeIndirectJMP(ICODE & pIcode, ParseTrace &trace, ParseWorklist &work)
 {
+    STATE *pstate = trace.state;
     PROG &prog(Project::get()->prog);
 //    mov cx,NUM_CASES
 //    mov bx,JUMP_TABLE
@@ -442,21 +985,17 @@ bool Function::decodeIndirectJMP(ICODE & pIcode, STATE *pstate, CALL_GRAPH * pca
     setBits(BM_DATA, table_addr, num_cases*2 + num_cases*2); // num_cases of short values + num cases short ptrs
     pIcode.ll()->setFlags(SWITCH);
 
+    std::vector<uint32_t> targets;
     for(int i=0; i<num_cases; ++i) {
-        STATE   StCopy = *pstate;
         uint32_t jump_target_location = table_addr + num_cases*2 + i*2;
-        StCopy.IP = cs + *(uint16_t *)(prog.image()+jump_target_location);
-        iICODE last_current_insn = (++Icode.entries.rbegin()).base();
-        FollowCtrl (pcallGraph, &StCopy);
-        ++last_current_insn;
-        last_current_insn->ll()->caseEntry = i;
-        last_current_insn->ll()->setFlags(CASE);
-        pIcode.ll()->caseTbl2.push_back( last_current_insn->ll()->GetLlLabel() );
+        targets.push_back(cs + prog.word(jump_target_location));
     }
+    work.followCases(trace, pIcode, std::move(targets));
     return true;
 }
-bool Function::decodeIndirectJMP2(ICODE & pIcode, STATE *pstate, CALL_GRAPH * pcallGraph)
+bool Function::decodeIndirectJMP2(ICODE & pIcode, ParseTrace &trace, ParseWorklist &work)
 {
+    STATE *pstate = trace.state;
     PROG &prog(Project::get()->prog);
 //    mov cx,NUM_CASES
 //    mov bx,JUMP_TABLE
@@ -528,32 +1067,28 @@ bool Function::decodeIndirectJMP2(ICODE & pIcode, STATE *pstate, CALL_GRAPH * pc
     setBits(BM_DATA, table_addr, num_cases*4 + num_cases*2); // num_cases of long values + num cases short ptrs
     pIcode.ll()->setFlags(SWITCH);
 
+    std::vector<uint32_t> targets;
     for(int i=0; i<num_cases; ++i) {
-        STATE   StCopy = *pstate;
         uint32_t jump_target_location = table_addr + num_cases*4 + i*2;
-        StCopy.IP = cs + *(uint16_t *)(prog.image()+jump_target_location);
-        iICODE last_current_insn = (++Icode.entries.rbegin()).base();
-        FollowCtrl (pcallGraph, &StCopy);
-        ++last_current_insn;
-        last_current_insn->ll()->caseEntry = i;
-        last_current_insn->ll()->setFlags(CASE);
-        pIcode.ll()->caseTbl2.push_back( last_current_insn->ll()->GetLlLabel() );
+        targets.push_back(cs + prog.word(jump_target_location));
     }
+    work.followCases(trace, pIcode, std::move(targets));
     return true;
 }
 
-bool Function::process_JMP (ICODE & pIcode, STATE *pstate, CALL_GRAPH * pcallGraph)
+bool Function::process_JMP (ICODE & pIcode, ParseTrace &trace, ParseWorklist &work)
 {
     PROG &prog(Project::get()->prog);
+    STATE *pstate = trace.state;
     static uint8_t i2r[4] = {rSI, rDI, rBP, rBX};
     ICODE       _Icode;
     uint32_t       cs, offTable, endTable;
-    uint32_t       i, k, seg, target;
+    uint32_t       i, seg, target;
 
     if (pIcode.ll()->testFlags(I))
     {
         if (pIcode.ll()->getOpcode() == iJMPF)
-            pstate->setState( rCS, LH(prog.image() + pIcode.ll()->label + 3));
+            pstate->setState( rCS, prog.word(pIcode.ll()->label + 3));
         pstate->IP = pIcode.ll()->src().getImm2();
         int64_t i = pIcode.ll()->src().getImm2();
         if (i < 0)
@@ -591,7 +1126,7 @@ bool Function::process_JMP (ICODE & pIcode, STATE *pstate, CALL_GRAPH * pcallGra
 
         /* Search for first uint8_t flagged after start of table */
         for (i = offTable; i <= endTable; i++)
-            if (BITMAP(i, BM_CODE | BM_DATA))
+            if (testBits(i, BM_CODE | BM_DATA))
                 break;
         endTable = i & ~1;      /* Max. possible table size */
 
@@ -601,7 +1136,7 @@ bool Function::process_JMP (ICODE & pIcode, STATE *pstate, CALL_GRAPH * pcallGra
         cs = (uint32_t)(uint16_t)pstate->r[rCS] << 4;
         for (i = offTable; i < endTable; i += 2)
         {
-            target = cs + LH(&prog.image()[i]);
+            target = cs + prog.word(i);
             if (target < endTable and target >= offTable)
                 endTable = target;
             else if (target >= (uint32_t)prog.cbImage)
@@ -610,48 +1145,35 @@ bool Function::process_JMP (ICODE & pIcode, STATE *pstate, CALL_GRAPH * pcallGra
 
         for (i = offTable; i < endTable; i += 2)
         {
-            target = cs + LH(&prog.image()[i]);
+            target = cs + prog.word(i);
             /* Be wary of 00 00 as code - it's probably data */
-            if (not (prog.image()[target] or prog.image()[target+1]) or
+            if (not (prog.byte(target) or prog.byte(target+1)) or
                     scan(target, _Icode))
                 endTable = i;
         }
 
         /* Now for each entry in the table take a copy of the current
-         * state and recursively call FollowCtrl(). */
+         * state and follow it on the worklist. */
         if (offTable < endTable)
         {
             assert(((endTable - offTable) / 2)<512);
-            STATE   StCopy;
-            //int     ip;
-            //uint32_t  *psw;
 
             setBits(BM_DATA, offTable, endTable - offTable);
 
             pIcode.ll()->setFlags(SWITCH);
             //pIcode.ll()->caseTbl2.numEntries = (endTable - offTable) / 2;
 
-            for (i = offTable, k = 0; i < endTable; i += 2)
-            {
-                StCopy = *pstate;
-                StCopy.IP = cs + LH(&prog.image()[i]);
-                iICODE last_current_insn = (++Icode.entries.rbegin()).base();
-                //ip = Icode.size();
-
-                FollowCtrl (pcallGraph, &StCopy);
-                ++last_current_insn;
-                last_current_insn->ll()->caseEntry = k++;
-                last_current_insn->ll()->setFlags(CASE);
-                pIcode.ll()->caseTbl2.push_back( last_current_insn->ll()->GetLlLabel() );
-
-            }
+            std::vector<uint32_t> targets;
+            for (i = offTable; i < endTable; i += 2)
+                targets.push_back(cs + prog.word(i));
+            work.followCases(trace, pIcode, std::move(targets));
             return true;
         }
     }
-    if(decodeIndirectJMP(pIcode,pstate,pcallGraph)) {
+    if(decodeIndirectJMP(pIcode,trace,work)) {
         return true;
     }
-    if(decodeIndirectJMP2(pIcode,pstate,pcallGraph)) {
+    if(decodeIndirectJMP2(pIcode,trace,work)) {
         return true;
     }
 
@@ -659,7 +1181,10 @@ bool Function::process_JMP (ICODE & pIcode, STATE *pstate, CALL_GRAPH * pcallGra
 
     flg |= PROC_IJMP;
     flg &= ~TERMINATES;
-    interactDis(this, Icode.entries.size()-1);
+    if (s_shard)
+        s_shard->add(ParseShard::Event::INTERACT, Icode.entries.size()-1);
+    else
+        interactDis(this, Icode.entries.size()-1);
     return true;
 }
 
@@ -673,11 +1198,12 @@ bool Function::process_JMP (ICODE & pIcode, STATE *pstate, CALL_GRAPH * pcallGra
  *       programmer expected it to come back - otherwise surely a JMP would
  *       have been used.  */
 
-bool Function::process_CALL(ICODE & pIcode, CALL_GRAPH * pcallGraph, STATE *pstate)
+bool Function::process_CALL(ICODE & pIcode, ParseTrace &trace, ParseWorklist &work)
 {
     PROG &prog(Project::get()->prog);
+    CALL_GRAPH *pcallGraph = work.callGraph();
+    STATE *pstate = trace.state;
     ICODE &last_insn(Icode.entries.back());
-    STATE localState;     /* Local copy of the machine state */
     uint32_t off;
     /* For Indirect Calls, find the function address */
     bool indirect = false;
@@ -707,7 +1233,7 @@ bool Function::process_CALL(ICODE & pIcode, CALL_GRAPH * pcallGraph, STATE *psta
                     not  pstate->isKnown(pIcode.ll()->m_dst.seg)
                     )
             {
-                fprintf(stderr,"Indirect call with unknown register values\n");
+                dccFprintf(stderr,"Indirect call with unknown register values\n");
                 return false;
             }
             off = pstate->r[pIcode.ll()->m_dst.seg];
@@ -725,9 +1251,9 @@ bool Function::process_CALL(ICODE & pIcode, CALL_GRAPH * pcallGraph, STATE *psta
          * previous offset into the program image */
         uint32_t tgtAddr=0;
         if (pIcode.ll()->getOpcode() == iCALLF)
-            tgtAddr= LH(&prog.image()[off]) + ((uint32_t)(LH(&prog.image()[off+2])) << 4);
+            tgtAddr= prog.word(off) + ((uint32_t)(prog.word(off+2)) << 4);
         else
-            tgtAddr= LH(&prog.image()[off]) + ((uint32_t)(uint16_t)state.r[rCS] << 4);
+            tgtAddr= prog.word(off) + ((uint32_t)(uint16_t)state.r[rCS] << 4);
         pIcode.ll()->replaceSrc(LLOperand::CreateImm2( tgtAddr ) );
         pIcode.ll()->setFlags(I);
         indirect = true;
@@ -739,12 +1265,32 @@ bool Function::process_CALL(ICODE & pIcode, CALL_GRAPH * pcallGraph, STATE *psta
         /* Search procedure list for one with appropriate entry point */
         ilFunction iter = Project::get()->findByEntry(pIcode.ll()->src().getImm2());
 
+        /* A parser worker leaves new procedures to the end of the round, and
+         * carries on without the callee's effect on the state */
+        if (s_shard)
+        {
+            ParseShard::Call call{&last_insn, pIcode.ll()->src().getImm2(), indirect, *pstate, nullptr};
+            if (Project::get()->valid(iter))
+            {
+                call.callee = &(*iter);
+                last_insn.ll()->src().proc.proc = call.callee;
+            }
+            else
+            {
+                call.state.IP = call.target;
+                if (pIcode.ll()->getOpcode() == iCALLF)
+                    call.state.setState( rCS, prog.word(pIcode.ll()->label + 3));
+            }
+            s_shard->calls.push_back(call);
+            s_shard->add(ParseShard::Event::CALL, s_shard->calls.size()-1);
+            return false;
+        }
+
         /* Create a new procedure node and save copy of the state */
         if ( not Project::get()->valid(iter) )
         {
-            iter = Project::get()->createFunction(0,"");
+            iter = Project::get()->createFunction(0,"",pIcode.ll()->src().getImm2());
             Function &x(*iter);
-            x.procEntry = pIcode.ll()->src().getImm2();
             LibCheck(x);
 
             if (x.flg & PROC_ISLIB)
@@ -766,26 +1312,19 @@ bool Function::process_CALL(ICODE & pIcode, CALL_GRAPH * pcallGraph, STATE *psta
             x.depth = x.depth + 1;
             x.flg |= TERMINATES;
 
-            /* Save machine state in localState, load up IP and CS.*/
-            localState = *pstate;
+            /* Save machine state in callerState, load up IP and CS.*/
+            trace.callerState = *pstate;
             pstate->IP = pIcode.ll()->src().getImm2();
             if (pIcode.ll()->getOpcode() == iCALLF)
-                pstate->setState( rCS, LH(prog.image() + pIcode.ll()->label + 3));
+                pstate->setState( rCS, prog.word(pIcode.ll()->label + 3));
             x.state = *pstate;
 
             /* Insert new procedure in call graph */
             pcallGraph->insertCallGraph (this, iter);
 
-            /* Process new procedure */
-            x.FollowCtrl (pcallGraph, pstate);
-
-            /* Restore segment registers & IP from localState */
-            pstate->IP = localState.IP;
-            pstate->setState( rCS, localState.r[rCS]);
-            pstate->setState( rDS, localState.r[rDS]);
-            pstate->setState( rES, localState.r[rES]);
-            pstate->setState( rSS, localState.r[rSS]);
-
+            /* Process new procedure on this state; the caller's segment
+             * registers & IP are restored once it is done (CALL_RETURN) */
+            work.push(&x, pstate);
         }
         else
             Project::get()->callGraph->insertCallGraph (this, iter);
@@ -813,7 +1352,7 @@ static void process_MOV(LLInst & ll, STATE * pstate)
         {
             psym = lookupAddr(&ll.src(), pstate, 2, eDuVal::USE);
             if (psym and ((psym->flg & SEG_IMMED) or psym->duVal.val))
-                pstate->setState( dstReg, LH(&prog.image()[psym->label]));
+                pstate->setState( dstReg, prog.word(psym->label));
         }
         else if (srcReg < INDEX_BX_SI and pstate->f[srcReg])  /* reg */
         {
@@ -840,7 +1379,7 @@ static void process_MOV(LLInst & ll, STATE * pstate)
                     pstate->setMemoryByte(psym->label+1,uint8_t(ll.src().getImm2()>>8));
                     //prog.image()[psym->label+1] = (uint8_t)(ll.src().getImm2()>>8);
                 }
-                psym->duVal.val = 1;
+                changeSymbols(SymbolOp(SymbolOp::SET_VAL, psym->label));
             }
             else if (srcReg == 0) /* direct mem offset */
             {
@@ -848,14 +1387,14 @@ static void process_MOV(LLInst & ll, STATE * pstate)
                 if (psym2 and ((psym->flg & SEG_IMMED) or (psym->duVal.val)))
                 {
                     //prog.image()[psym->label] = (uint8_t)prog.image()[psym2->label];
-                    pstate->setMemoryByte(psym->label,(uint8_t)prog.image()[psym2->label]);
+                    pstate->setMemoryByte(psym->label,(uint8_t)prog.byte(psym2->label));
                     if(psym->size>1)
                     {
-                        pstate->setMemoryByte(psym->label+1,(uint8_t)prog.image()[psym2->label+1]);
+                        pstate->setMemoryByte(psym->label+1,(uint8_t)prog.byte(psym2->label+1));
                         //prog.image()[psym->label+1] = prog.image()[psym2->label+1];//(uint8_t)(prog.image()[psym2->label+1] >> 8);
                     }
-                    psym->duVal.setFlags(eDuVal::DEF);
-                    psym2->duVal.setFlags(eDuVal::USE);
+                    changeSymbols(SymbolOp(SymbolOp::DU_FLAGS, psym->label, 0, eDuVal::DEF));
+                    changeSymbols(SymbolOp(SymbolOp::DU_FLAGS, psym2->label, 0, eDuVal::USE));
                 }
             }
             else if (srcReg < INDEX_BX_SI and pstate->f[srcReg])  /* reg */
@@ -867,7 +1406,7 @@ static void process_MOV(LLInst & ll, STATE * pstate)
                     pstate->setMemoryByte(psym->label,(uint8_t)pstate->r[srcReg]>>8);
                     //prog.image()[psym->label+1] = (uint8_t)(pstate->r[srcReg] >> 8);
                 }
-                psym->duVal.setFlags(eDuVal::DEF);
+                changeSymbols(SymbolOp(SymbolOp::DU_FLAGS, psym->label, 0, eDuVal::DEF));
             }
         }
     }
@@ -924,10 +1463,8 @@ void STKFRAME::updateFrameOff ( int16_t off, int _size, uint16_t duFlag)
 static SYM * lookupAddr (LLOperand *pm, STATE *pstate, int size, uint16_t duFlag)
 {
     PROG &prog(Project::get()->prog);
-    int     i;
     SYM *    psym=nullptr;
     uint32_t   operand;
-    bool created_new=false;
     if (pm->regi != rUNDEF)
         return nullptr; // register or indexed
 
@@ -935,25 +1472,14 @@ static SYM * lookupAddr (LLOperand *pm, STATE *pstate, int size, uint16_t duFlag
     if (pm->segValue)  /* there is a value in the seg field */
     {
         operand = opAdr (pm->segValue, pm->off);
-        psym = Project::get()->symtab.updateGlobSym (operand, size, duFlag,created_new);
+        psym = changeSymbols(SymbolOp(SymbolOp::LOOKUP, operand, size, duFlag));
     }
     else if (pstate->f[pm->seg]) /* new value */
     {
         pm->segValue = pstate->r[pm->seg];
         operand = opAdr(pm->segValue, pm->off);
-        psym = Project::get()->symtab.updateGlobSym (operand, size, duFlag,created_new);
-
         /* Flag new memory locations that are segment values */
-        if (created_new)
-        {
-            if (size == 4)
-                operand += 2;   /* High uint16_t */
-            for (i = 0; i < prog.cReloc; i++)
-                if (prog.relocTable[i] == operand) {
-                    psym->flg = SEG_IMMED;
-                    break;
-                }
-        }
+        psym = changeSymbols(SymbolOp(SymbolOp::LOOKUP, operand, size, duFlag, true));
     }
     /* Check for out of bounds */
     if (psym and (psym->label < (uint32_t)prog.cbImage))
@@ -998,22 +1524,21 @@ void STATE::setState(uint16_t reg, int16_t value)
     replaces *pIndex with an icode index */
 
 
-/* setBits - Sets memory bitmap bits for BM_CODE or BM_DATA (additively) */
+/* setBits - Sets memory bitmap bits for BM_CODE or BM_DATA (additively).
+ * Bits set on a parser worker are merged into prog.map after the round. Data
+ * drops the instructions decoded there from the DecodeCache */
 static void setBits(int16_t type, uint32_t start, uint32_t len)
 {
     PROG &prog(Project::get()->prog);
-    uint32_t   i;
 
     if (start < (uint32_t)prog.cbImage)
     {
         if (start + len > (uint32_t)prog.cbImage)
             len = (uint32_t)(prog.cbImage - start);
 
-        for (i = start + len - 1; i >= start; i--)
-        {
-            prog.map[i >> 2] |= type << ((i & 3) << 1);
-            if (i == 0) break;		// Fixes inf loop!
-        }
+        if ((type & BM_DATA) and not s_shard)
+            Project::get()->decoded.invalidate(start, len);
+        (s_shard ? s_shard->map : prog.map).set(start, len, type);
     }
 }
 
@@ -1061,7 +1586,7 @@ static void use (opLoc d, ICODE & pIcode, Function * pProc, STATE * pstate, int
             {
                 setBits (BM_DATA, psym->label, (uint32_t)size);
                 pIcode.ll()->setFlags(SYM_USE);
-                pIcode.ll()->caseEntry = distance<const SYM *>(&Project::get()->symtab[0],psym); //WARNING: was setting case count
+                pIcode.ll()->caseEntry = symbolIndex(psym); //WARNING: was setting case count
 
             }
         }
@@ -1086,7 +1611,7 @@ static void def (opLoc d, ICODE & pIcode, Function * pProc, STATE * pstate, int
         {
             setBits(BM_DATA, psym->label, (uint32_t)size);
             pIcode.ll()->setFlags(SYM_DEF);
-            pIcode.ll()->caseEntry = distance<const SYM *>(&Project::get()->symtab[0],psym); // WARNING: was setting Case count
+            pIcode.ll()->caseEntry = symbolIndex(psym); // WARNING: was setting Case count
         }
     }
     else if (pm->regi >= INDEX_BX_SI)
@@ -1145,14 +1670,12 @@ static void use_def(opLoc d, ICODE & pIcode, Function * pProc, STATE * pstate, i
 
 /* Set DU vector, local variables and arguments, and DATA bits in the
  * bitmap       */
-extern LLOperand convertOperand(const x86_op_t &from);
 void Function::process_operands(ICODE & pIcode,  STATE * pstate)
 {
     LLInst &ll_ins(*pIcode.ll());
 
     int   sseg = (ll_ins.src().seg)? ll_ins.src().seg: rDS;
     int   cb   = pIcode.ll()->testFlags(B) ? 1: 2;
-    //x86_op_t *im= pIcode.insn.x86_get_imm();
     bool Imm  = (pIcode.ll()->testFlags(I));
 
     switch (pIcode.ll()->getOpcode()) {
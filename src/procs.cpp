@@ -11,6 +11,7 @@
 #include "CallGraph.h"
 
 #include <QtCore/QDebug>
+#include <algorithm>
 #include <cstring>
 #include <cassert>
 
@@ -26,58 +27,131 @@ const char *indentStr(int indLevel) // Indentation according to the depth of the
 }
 
 
-/* Inserts an outEdge at the current callGraph pointer if the newProc does
- * not exist.  */
-void CALL_GRAPH::insertArc (ilFunction newProc)
+CALL_GRAPH::CALL_GRAPH(ilFunction root)
 {
+    insertNode(root);
+}
 
 
-    /* Check if procedure already exists */
-    auto res=std::find_if(outEdges.begin(),outEdges.end(),[newProc](CALL_GRAPH *e) {return e->proc==newProc;});
-    if(res!=outEdges.end())
-        return;
-    /* Include new arc */
-    CALL_GRAPH *pcg = new CALL_GRAPH;
-    pcg->proc = newProc;
-    outEdges.push_back(pcg);
+/* Returns the index of the node for proc, creating it if it does not exist. */
+int CALL_GRAPH::insertNode(ilFunction proc)
+{
+    auto res = m_nodeIndex.emplace(&(*proc),int(m_nodes.size()));
+    if(res.second)
+    {
+        m_nodes.emplace_back();
+        m_nodes.back().proc = proc;
+    }
+    return res.first->second;
+}
+
+
+int CALL_GRAPH::findNode(const Function *proc) const
+{
+    auto iter = m_nodeIndex.find(proc);
+    return (iter==m_nodeIndex.end()) ? -1 : iter->second;
 }
 
 
-/* Inserts a (caller, callee) arc in the call graph tree. */
+/* Inserts a (caller, callee) arc in the call graph, unless it already exists.
+ * The caller has to be in the graph already. */
 bool CALL_GRAPH::insertCallGraph(ilFunction caller, ilFunction callee)
 {
-    if (proc == caller)
-    {
-        insertArc (callee);
-        return true;
-    }
-        for (CALL_GRAPH *edg : outEdges)
-            if (edg->insertCallGraph (caller, callee))
-                return true;
-    return false;
+    return insertCallGraph(&(*caller),callee);
 }
 
 bool CALL_GRAPH::insertCallGraph(Function *caller, ilFunction callee)
 {
-    return insertCallGraph(Project::get()->funcIter(caller),callee);
+    int from = findNode(caller);
+    if(from<0)
+        return false;
+    int to = insertNode(callee);
+    if(not m_edges.insert((uint64_t(uint32_t(from))<<32) | uint32_t(to)).second)
+        return true;
+    m_nodes[from].outEdges.push_back(to);
+    m_nodes[to].inEdges.push_back(from);
+    return true;
+}
+
+
+/* Tarjan's algorithm, with an explicit stack so deep call chains do not
+ * overflow the native one. Components are produced callees-first. */
+std::vector<CALL_GRAPH::Component> CALL_GRAPH::stronglyConnectedComponents() const
+{
+    std::vector<Component> res;
+    std::vector<int> index(m_nodes.size(),-1);
+    std::vector<int> lowlink(m_nodes.size(),0);
+    std::vector<bool> onStack(m_nodes.size(),false);
+    std::vector<int> sccStack;
+    std::vector<std::pair<int,size_t> > dfsStack; /* node, next out edge to visit */
+    int counter = 0;
+    for(int start=0; start<int(m_nodes.size()); ++start)
+    {
+        if(index[start]!=-1)
+            continue;
+        dfsStack.emplace_back(start,0);
+        while(not dfsStack.empty())
+        {
+            int v = dfsStack.back().first;
+            size_t &edge(dfsStack.back().second);
+            if(edge==0 and index[v]==-1)
+            {
+                index[v] = lowlink[v] = counter++;
+                sccStack.push_back(v);
+                onStack[v] = true;
+            }
+            if(edge<m_nodes[v].outEdges.size())
+            {
+                int w = m_nodes[v].outEdges[edge++];
+                if(index[w]==-1)
+                    dfsStack.emplace_back(w,0);
+                else if(onStack[w])
+                    lowlink[v] = std::min(lowlink[v],index[w]);
+                continue;
+            }
+            dfsStack.pop_back();
+            if(not dfsStack.empty())
+            {
+                int parent = dfsStack.back().first;
+                lowlink[parent] = std::min(lowlink[parent],lowlink[v]);
+            }
+            if(lowlink[v]!=index[v])
+                continue;
+            res.emplace_back();
+            int w;
+            do
+            {
+                w = sccStack.back();
+                sccStack.pop_back();
+                onStack[w] = false;
+                res.back().push_back(w);
+            } while(w!=v);
+        }
+    }
+    return res;
 }
 
 
 /* Displays the current node of the call graph, and invokes recursively on
- * the nodes the procedure invokes. */
-void CALL_GRAPH::writeNodeCallGraph(int indIdx)
+ * the nodes the procedure invokes. Procedures already expanded are only
+ * listed by name. */
+void CALL_GRAPH::writeNodeCallGraph(int idx, int indIdx, std::vector<bool> &expanded) const
 {
-    qDebug() << indentStr(indIdx)+proc->name;
-    for (CALL_GRAPH *cg : outEdges)
-        cg->writeNodeCallGraph (indIdx + 1);
+    qDebug() << indentStr(indIdx)+m_nodes[idx].proc->name;
+    if(expanded[idx])
+        return;
+    expanded[idx] = true;
+    for (int callee : m_nodes[idx].outEdges)
+        writeNodeCallGraph (callee, indIdx + 1, expanded);
 }
 
 
 /* Writes the header and invokes recursive procedure */
 void CALL_GRAPH::write()
 {
+    std::vector<bool> expanded(m_nodes.size(),false);
     printf ("\nCall Graph:\n");
-    writeNodeCallGraph (0);
+    writeNodeCallGraph (root(), 0, expanded);
 }
 
 
@@ -161,6 +235,7 @@ void LOCAL_ID::newRegArg(ICODE &picode, ICODE &ticode) const
     if (!regExist)
     {
         STKSYM newsym;
+        ExprArena::Scope scope(tproc->m_exprs); /* the formal argument lives in tproc */
 
         newsym.setArgName(target_stackframe->size());
 
@@ -299,9 +374,7 @@ Expr *Function::adjustActArgType (Expr *_exp, hlType forType)
                         offset = (state.r[rDS]<<4) + offL + 0x100;
                     else
                         offset = (state.r[rDS]<<4) + offL;
-                    expr->ident.idNode.strIdx = offset;
-                    expr->ident.type(STRING);
-                    delete c;
+                    Expr::destroy(c);
                     return AstIdent::String(offset);
                 }
 
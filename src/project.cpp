@@ -1,5 +1,6 @@
 #include <QtCore/QString>
 #include <QtCore/QDir>
+#include <mutex>
 #include <utility>
 #include "dcc.h"
 #include "CallGraph.h"
@@ -9,7 +10,7 @@
 using namespace std;
 
 QString asm1_name, asm2_name;     /* Assembler output filenames     */
-STATS   stats;              /* cfg statistics                       */
+thread_local STATS stats;   /* cfg statistics                       */
 OPTION  option;             /* Command line options                 */
 Project *Project::s_instance = nullptr;
 Project::Project() : callGraph(nullptr)
@@ -38,35 +39,34 @@ bool Project::valid(ilFunction iter)
 }
 ilFunction Project::funcIter(Function *to_find)
 {
-    auto iter=std::find_if(pProcList.begin(),pProcList.end(),
-                           [to_find](const Function &f)->bool {return to_find==&f;});
-    assert(iter!=pProcList.end());
-    return iter;
+    auto iter=m_procIndex.find(to_find);
+    assert(iter!=m_procIndex.end());
+    return iter->second;
 }
 
 ilFunction Project::findByEntry(uint32_t entry)
 {
     /* Search procedure list for one with appropriate entry point */
-    ilFunction iter= std::find_if(pProcList.begin(),pProcList.end(),
-                                  [entry](const Function &f)  { return f.procEntry==entry; });
-    return iter;
+    auto iter=m_entryIndex.find(entry);
+    if(iter==m_entryIndex.end())
+        return pProcList.end();
+    return iter->second;
 }
 
-ilFunction Project::createFunction(FunctionType *f,const QString &name)
+ilFunction Project::createFunction(FunctionType *f,const QString &name,uint32_t entry)
 {
     pProcList.push_back(*Function::Create(f,0,name,nullptr));
-    return (++pProcList.rbegin()).base();
+    ilFunction res = (++pProcList.rbegin()).base();
+    res->procEntry = entry;
+    /* On a duplicate entry point the first procedure keeps being found */
+    m_entryIndex.emplace(entry,res);
+    m_procIndex.emplace(&(*res),res);
+    return res;
 }
 
 int Project::getSymIdxByAddr(uint32_t adr)
 {
-    size_t i;
-    for (i = 0; i < symtab.size(); i++) {
-        if (symtab[i].label == adr) {
-            break;
-        }
-    }
-    return i;
+    return symtab.findByLabel(adr)-symtab.begin();
 }
 
 bool Project::validSymIdx(size_t idx)
@@ -99,9 +99,8 @@ const QString &Project::symbolName(size_t idx)
 
 Project *Project::get()
 {
-    //WARNING: poor man's singleton, not thread safe
-    if(s_instance==nullptr)
-        s_instance=new Project;
+    static std::once_flag created;
+    std::call_once(created, []() { s_instance=new Project; });
     return s_instance;
 }
 
@@ -62,7 +62,7 @@ static bool isLong23 (BB * pbb, iICODE &off, int *arc)
 static bool isLong22 (iICODE pIcode, iICODE pEnd, iICODE &off)
 {
     iICODE initial_icode=pIcode;
-    if(distance(pIcode,pEnd)<4)
+    if(std::distance(pIcode,pEnd)<4)
         return false;
     // preincrement because pIcode is not checked here
     iICODE icodes[] = { ++pIcode,++pIcode,++pIcode };
@@ -71,7 +71,7 @@ static bool isLong22 (iICODE pIcode, iICODE pEnd, iICODE &off)
            (isJCond (icodes[2]->ll()->getOpcode())))
     {
         off = initial_icode;
-        advance(off,2);
+        std::advance(off,2);
         return true;
     }
     return false;
@@ -140,7 +140,7 @@ static int longJCond23 (Assignment &asgn, iICODE pIcode, int arc, iICODE atOffse
         skipped_insn = 2;
     }
     iICODE atOffset1(atOffset),next1(++iICODE(pIcode));
-    advance(atOffset1,1);
+    std::advance(atOffset1,1);
     /* Create new HLI_JCOND and condition */
     condOp oper=condOpJCond[atOffset1->ll()->getOpcode()-iJB];
     asgn.lhs = new BinaryOperator(oper,asgn.lhs, asgn.rhs);
@@ -172,7 +172,7 @@ static int longJCond22 (Assignment &asgn, iICODE pIcode,iICODE pEnd)
 {
 
     BB * pbb, * obb1, * tbb;
-    if(distance(pIcode,pEnd)<4)
+    if(std::distance(pIcode,pEnd)<4)
         return false;
     // preincrement because pIcode is not checked here
     const iICODE icodes[4] = { pIcode++,pIcode++,pIcode++,pIcode++ };
@@ -286,7 +286,7 @@ void Function::propLongStk (int i, const ID &pLocId)
                     next1->invalidate();
                     break;
                 default:
-                    printf("Wild ass checkLongEq success on opcode %d\n",pIcode->ll()->getOpcode());
+                    dccPrintf("Wild ass checkLongEq success on opcode %d\n",pIcode->ll()->getOpcode());
                 } /*eos*/
             }
         }
@@ -296,7 +296,7 @@ void Function::propLongStk (int i, const ID &pLocId)
         {
             if ( checkLongEq (pLocId.longStkId(), pIcode, i, this, asgn, *l23->ll()) )
             {
-                advance(pIcode,longJCond23 (asgn, pIcode, arc, l23));
+                std::advance(pIcode,longJCond23 (asgn, pIcode, arc, l23));
             }
         }
 
@@ -306,7 +306,7 @@ void Function::propLongStk (int i, const ID &pLocId)
         {
             if ( checkLongEq (pLocId.longStkId(), pIcode, i, this,asgn, *l23->ll()) )
             {
-                advance(pIcode,longJCond22 (asgn, pIcode,pEnd));
+                std::advance(pIcode,longJCond22 (asgn, pIcode,pEnd));
             }
         }
     }
@@ -485,7 +485,7 @@ int Function::findForwardLongUses(int loc_ident_idx, const LONGID_TYPE &loc_id_l
             if (checkLongRegEq (loc_id_longid, pIcode, loc_ident_idx, this, asgn, *long_loc->ll()))
             {
                 // reduce the advance by 1 here (loop increases) ?
-                advance(pIcode,longJCond23 (asgn, pIcode, arc, long_loc));
+                std::advance(pIcode,longJCond23 (asgn, pIcode, arc, long_loc));
             }
         }
 
@@ -496,7 +496,7 @@ int Function::findForwardLongUses(int loc_ident_idx, const LONGID_TYPE &loc_id_l
             if (checkLongRegEq (loc_id_longid, pIcode, loc_ident_idx, this, asgn, *long_loc->ll()) )
             {
                 // TODO: verify that removing -1 does not change anything !
-                advance(pIcode,longJCond22 (asgn, pIcode,pEnd));
+                std::advance(pIcode,longJCond22 (asgn, pIcode,pEnd));
             }
         }
 
@@ -509,7 +509,7 @@ int Function::findForwardLongUses(int loc_ident_idx, const LONGID_TYPE &loc_id_l
             if (loc_id_longid.srcDstRegMatch(pIcode,pIcode))
             {
                 asgn.lhs = AstIdent::LongIdx (loc_ident_idx);
-                asgn.rhs = new Constant(0, 4);  /* long 0 */
+                asgn.rhs = Constant::Create(0, 4);  /* long 0 */
                 asgn.lhs = new BinaryOperator(condOpJCond[next1->ll()->getOpcode() - iJB],asgn.lhs, asgn.rhs);
                 next1->setJCond(asgn.lhs);
                 next1->copyDU(*pIcode, eUSE, eUSE);
@@ -555,7 +555,7 @@ void Function::propLongReg (int loc_ident_idx, const ID &pLocId)
  * Transforms some LOW_LEVEL icodes into HIGH_LEVEL     */
 void Function::propLongGlb (int /*i*/, const ID &/*pLocId*/)
 {
-    printf("WARN: Function::propLongGlb not implemented\n");
+    dccPrintf("WARN: Function::propLongGlb not implemented\n");
 }
 
 
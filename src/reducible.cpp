@@ -24,28 +24,38 @@ bool trivialGraph(BB *G)
 /* Returns whether the graph is a trivial graph or not */
 
 
-/* Returns the first element in the queue Q, and removes this element
- * from the list.  Q is not an empty queue.                 */
-static BB *firstOfQueue (queue &Q)
+/* States of BB::beenOnH. A node is put on the header list H at most once;
+ * nodes that leave H before their turn are skipped when H is consumed. */
+enum eHeaderListState
 {
-    assert(not Q.empty());
-    BB *res=Q.front();
-    Q.pop_front();
-    return res;
-}
-
+    NEVER_ON_H=0,
+    ON_H=1,     /* waiting on H */
+    LEFT_H=2    /* taken off H, either as a header or into an interval */
+};
 
-/* Appends pointer to node at the end of the queue Q if node is not present
- * in this queue.  Returns the queue node just appended.        */
-queue::iterator appendQueue (queue &Q, BB *node)
+/* Appends node to the header list Q; node must not have been on it. */
+static void appendHeader (queue &Q, BB *node)
 {
-    auto iter=std::find(Q.begin(),Q.end(),node);
-    if(iter!=Q.end())
-        return iter;
+    assert(node->beenOnH == NEVER_ON_H);
     Q.push_back(node);
-    iter=Q.end();
-    --iter;
-    return iter;
+    node->beenOnH = ON_H;
+}
+
+/* Returns the first node of the header list Q that is still waiting on it,
+ * starting from position head, and takes it off the list.  Returns nullptr
+ * once all nodes have been taken off. */
+static BB *firstOfQueue (queue &Q, size_t &head)
+{
+    while (head < Q.size())
+    {
+        BB *res = Q[head++];
+        if (res->beenOnH == ON_H)
+        {
+            res->beenOnH = LEFT_H;
+            return res;
+        }
+    }
+    return nullptr;
 }
 
 
@@ -54,41 +64,30 @@ queue::iterator appendQueue (queue &Q, BB *node)
  * the currNode pointer to the next unprocessed element.  */
 BB *interval::firstOfInt ()
 {
-    auto pq = currNode;
-    if (pq == nodes.end())
+    if (currNode == nodes.size())
         return nullptr;
-    ++currNode;
-    return *pq;
+    return nodes[currNode++];
 }
 
 
-/* Appends node @node to the end of the interval list @pI, updates currNode
- * if necessary, and removes the node from the header list @pqH if it is
- * there.  The interval header information is placed in the field
- * node->inInterval.
+/* Appends node @node to the end of the interval list @pI if it is not there
+ * yet, and removes the node from the header list H if it is waiting on
+ * it.  The interval header information is placed in the field
+ * node->inInterval, which is also what marks membership of the interval.
  * Note: nodes are added to the interval list in interval order (which
  * topsorts the dominance relation).                    */
-void interval::appendNodeInt(queue &pqH, BB *node)
+void interval::appendNodeInt(BB *node)
 {
-    queue::iterator pq;        /* Pointer to current node of the list      */
-
     /* Append node if it is not already in the interval list */
-    pq = appendQueue (nodes, node);
-
-    /* Update currNode if necessary */
-    if (currNode == nodes.end())
-        currNode = pq;
+    if (node->inInterval != this)
+        nodes.push_back(node);
 
     /* Check header list for occurrence of node, if found, remove it
      * and decrement number of out-edges from this interval.    */
-    if (node->beenOnH and not pqH.empty())
+    if (node->beenOnH == ON_H)
     {
-        auto found_iter=std::find(pqH.begin(),pqH.end(),node);
-        if(found_iter!=pqH.end())
-        {
-            numOutEdges -= (uint8_t)(*found_iter)->inEdges.size() - 1;
-            pqH.erase(found_iter);
-        }
+        numOutEdges -= (uint8_t)node->inEdges.size() - 1;
+        node->beenOnH = LEFT_H;
     }
     /* Update interval header information for this basic block */
     node->inInterval = this;
@@ -99,30 +98,22 @@ void interval::appendNodeInt(queue &pqH, BB *node)
  * Algorithm by M.S.Hecht.                      */
 void derSeq_Entry::findIntervals (Function *c)
 {
-    interval *pI,        /* Interval being processed         */
-             *J;         /* ^ last interval in derivedGi->Ii */
+    interval *pI;        /* Interval being processed         */
     BB *h,           /* Node being processed         */
             *header,          /* Current interval's header node   */
             *succ;            /* Successor basic block        */
     queue H;            /* Queue of possible header nodes   */
-    bool first = true;       /* First pass through the loop      */
+    size_t headH = 0;   /* First position of H not consumed yet */
 
-    appendQueue (H, Gi);  /* H = {first node of G} */
-    Gi->beenOnH = true;
+    appendHeader (H, Gi);  /* H = {first node of G} */
     Gi->reachingInt = BB::Create(nullptr,"",c); /* ^ empty BB */
 
     /* Process header nodes list H */
-    while (not H.empty())
+    while ((header = firstOfQueue (H, headH)) != nullptr)
     {
-        header = firstOfQueue (H);
-        pI = new interval;
+        pI = &m_intervals.emplace_back();
         pI->numInt = (uint8_t)numInt++;
-        if (first)               /* ^ to first interval  */
-        {
-            Ii = J = pI;
-            m_intervals.push_back(pI);
-        }
-        pI->appendNodeInt (H, header);   /* pI(header) = {header} */
+        pI->appendNodeInt (header);   /* pI(header) = {header} */
 
         /* Process all nodes in the current interval list */
         while ((h = pI->firstOfInt()) != nullptr)
@@ -137,11 +128,10 @@ void derSeq_Entry::findIntervals (Function *c)
                 {
                     succ->reachingInt = header;
                     if (succ->inEdgeCount == 0)
-                        pI->appendNodeInt (H, succ);
+                        pI->appendNodeInt (succ);
                     else if (not succ->beenOnH) /* out edge */
                     {
-                        appendQueue (H, succ);
-                        succ->beenOnH = true;
+                        appendHeader (H, succ);
                         pI->numOutEdges++;
                     }
                 }
@@ -151,7 +141,7 @@ void derSeq_Entry::findIntervals (Function *c)
                         if (succ->reachingInt == header or succ->inInterval == pI) /* same interval */
                         {
                             if (succ != header)
-                                pI->appendNodeInt (H, succ);
+                                pI->appendNodeInt (succ);
                         }
                         else            /* out edge */
                             pI->numOutEdges++;
@@ -160,34 +150,22 @@ void derSeq_Entry::findIntervals (Function *c)
                         pI->numOutEdges++;
             }
         }
-
-        /* Link interval I to list of intervals */
-        if (not first)
-        {
-            m_intervals.push_back(pI);
-            J->next = pI;
-            J = pI;
-        }
-        else     /* first interval */
-            first = false;
     }
 }
 
 /* Displays the intervals of the graph Gi.              */
-static void displayIntervals (interval *pI)
+static void displayIntervals (const ChunkedVector<interval> &intervals)
 {
-
-    while (pI)
+    for (const interval &I : intervals)
     {
-        printf ("  Interval #: %d\t#OutEdges: %d\n", pI->numInt, pI->numOutEdges);
-        for(BB *node : pI->nodes)
+        printf ("  Interval #: %d\t#OutEdges: %d\n", I.numInt, I.numOutEdges);
+        for(BB *node : I.nodes)
         {
             if (node->correspInt == nullptr)    /* real BBs */
                 printf ("    Node: %d\n", node->begin()->loc_ip);
             else             // BBs represent intervals
                 printf ("   Node (corresp int): %d\n", node->correspInt->numInt);
         }
-        pI = pI->next;
     }
 }
 
@@ -205,57 +183,29 @@ static void displayIntervals (interval *pI)
 //    q.clear();
 //}
 
-/* Frees the storage allocated for the interval pI */
-static void freeInterval (interval **pI)
-{
-    interval *Iptr;
-
-    while (*pI)
-    {
-        (*pI)->nodes.clear();
-        Iptr = *pI;
-        *pI = (*pI)->next;
-        delete (Iptr);
-    }
-}
-
-/* Frees the storage allocated by the derived sequence structure, except
- * for the original graph cfg (derivedG->Gi).               */
-void freeDerivedSeq(derSeq &derivedG)
-{
-    derivedG.entries.clear();
-}
-
-derSeq_Entry::~derSeq_Entry()
-{
-    freeInterval (&Ii);
-    //    if(Gi and Gi->nodeType == INTERVAL_NODE)
-    //        freeCFG (Gi);
-}
-
 /* Finds the next order graph of derivedGi->Gi according to its intervals
  * (derivedGi->Ii), and places it in derivedGi->next->Gi.       */
 bool Function::nextOrderGraph (derSeq &derivedGi)
 {
-    interval *Ii;   /* Interval being processed         */
     BB *BBnode;     /* New basic block of intervals         */
     bool   sameGraph; /* Boolean, isomorphic graphs           */
 
-    /* Process Gi's intervals */
-    derSeq_Entry &prev_entry(derivedGi.entries.back());
-    derivedGi.entries.push_back(derSeq_Entry());
+    /* Process Gi's intervals; entries may move when the vector grows, the
+     * intervals they hold do not */
+    derivedGi.entries.emplace_back();
+    derSeq_Entry &prev_entry(derivedGi.entries[derivedGi.entries.size()-2]);
     derSeq_Entry &new_entry(derivedGi.entries.back());
 
     sameGraph = true;
     BBnode = nullptr;
     std::vector<BB *> bbs;
-    for(Ii = prev_entry.Ii; Ii != nullptr; Ii = Ii->next)
+    for(interval &Ii : prev_entry.m_intervals)
     {
 
         BBnode = BB::CreateIntervalBB(this);
-        BBnode->correspInt = Ii;
+        BBnode->correspInt = &Ii;
         bbs.push_back(BBnode);
-        const queue &listIi(Ii->nodes);
+        const queue &listIi(Ii.nodes);
 
         /* Check for more than 1 interval */
         if (sameGraph and (listIi.size()>1))
@@ -263,7 +213,7 @@ bool Function::nextOrderGraph (derSeq &derivedGi)
 
         /* Find out edges */
 
-        if (Ii->numOutEdges <= 0)
+        if (Ii.numOutEdges <= 0)
             continue;
         for(BB *curr :  listIi)
         {
@@ -304,25 +254,24 @@ bool Function::nextOrderGraph (derSeq &derivedGi)
 bool Function::findDerivedSeq (derSeq &derivedGi)
 {
     assert(!derivedGi.entries.empty());
-    auto iter=derivedGi.entries.begin();
-    BB *Gi = iter->Gi;      /* Current derived sequence graph       */
+    size_t idx = 0;         /* Index of Gi in the derived sequence  */
+    BB *Gi = derivedGi.entries[idx].Gi;      /* Current derived sequence graph       */
     while (not trivialGraph (Gi))
     {
         /* Find the intervals of Gi and place them in derivedGi->Ii */
-        iter->findIntervals(this);
+        derivedGi.entries[idx].findIntervals(this);
 
         /* Create Gi+1 and check if it is equivalent to Gi */
         if (not nextOrderGraph (derivedGi))
             break;
-        ++iter;
-        Gi = iter->Gi;
+        ++idx;
+        Gi = derivedGi.entries[idx].Gi;
         stats.nOrder++;
     }
 
     if (not trivialGraph (Gi))
     {
-        ++iter;
-        derivedGi.entries.erase(iter,derivedGi.entries.end()); /* remove Gi+1 */
+        derivedGi.entries.erase(derivedGi.entries.begin()+idx+1,derivedGi.entries.end()); /* remove Gi+1 */
         //        freeDerivedSeq(derivedGi->next);
         //        derivedGi->next = NULL;
         return false;
@@ -340,7 +289,7 @@ void derSeq::display()
     while (iter!=entries.end())
     {
         printf ("\nIntervals for G%X\n", n++);
-        displayIntervals (iter->Ii);
+        displayIntervals (iter->m_intervals);
         ++iter;
     }
 }
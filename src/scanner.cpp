@@ -10,10 +10,6 @@
 #include "dcc.h"
 #include "project.h"
 
-#include <cstring>
-#include <map>
-#include <string>
-
 /*  Parser flags  */
 #define TO_REG      0x000100    /* rm is source  */
 #define S_EXT       0x000200    /* sign extend   */
@@ -49,6 +45,7 @@ static void const3(int i);
 static void none1(int i);
 static void none2(int i);
 static void checkInt(int i);
+static eErrorId decode(uint32_t ip, ICODE &p);
 
 #define IC      llIcode
 
@@ -171,22 +168,22 @@ static const StateTabelEntry stateTable[] = {
     {  strop,  memImp, NOT_HLL | IM_OPS         , iINS  },    /* 6D */
     {  strop,  memImp, NOT_HLL | B|IM_OPS       , iOUTS },    /* 6E */
     {  strop,  memImp, NOT_HLL | IM_OPS         , iOUTS },    /* 6F */
-    {  dispS,   none2, NOT_HLL                  , iJO    },    /* 70 */
-    {  dispS,   none2, NOT_HLL                  , iJNO    },    /* 71 */
-    {  dispS,   none2, 0                        , iJB    },    /* 72 */
-    {  dispS,   none2, 0                        , iJAE    },    /* 73 */
-    {  dispS,   none2, 0                        , iJE    },    /* 74 */
-    {  dispS,   none2, 0                        , iJNE    },    /* 75 */
-    {  dispS,   none2, 0                        , iJBE    },    /* 76 */
-    {  dispS,   none2, 0                        , iJA    },    /* 77 */
-    {  dispS,   none2, 0                        , iJS    },    /* 78 */
-    {  dispS,   none2, 0                        , iJNS    },    /* 79 */
-    {  dispS,   none2, NOT_HLL                  , iJP    },    /* 7A */
-    {  dispS,   none2, NOT_HLL                  , iJNP    },    /* 7B */
-    {  dispS,   none2, 0                        , iJL    },    /* 7C */
-    {  dispS,   none2, 0                        , iJGE    },    /* 7D */
-    {  dispS,   none2, 0                        , iJLE    },    /* 7E */
-    {  dispS,   none2, 0                        , iJG    },    /* 7F */
+    {  dispS,   none1, NOT_HLL                  , iJO    },    /* 70 */
+    {  dispS,   none1, NOT_HLL                  , iJNO    },    /* 71 */
+    {  dispS,   none1, 0                        , iJB    },    /* 72 */
+    {  dispS,   none1, 0                        , iJAE    },    /* 73 */
+    {  dispS,   none1, 0                        , iJE    },    /* 74 */
+    {  dispS,   none1, 0                        , iJNE    },    /* 75 */
+    {  dispS,   none1, 0                        , iJBE    },    /* 76 */
+    {  dispS,   none1, 0                        , iJA    },    /* 77 */
+    {  dispS,   none1, 0                        , iJS    },    /* 78 */
+    {  dispS,   none1, 0                        , iJNS    },    /* 79 */
+    {  dispS,   none1, NOT_HLL                  , iJP    },    /* 7A */
+    {  dispS,   none1, NOT_HLL                  , iJNP    },    /* 7B */
+    {  dispS,   none1, 0                        , iJL    },    /* 7C */
+    {  dispS,   none1, 0                        , iJGE    },    /* 7D */
+    {  dispS,   none1, 0                        , iJLE    },    /* 7E */
+    {  dispS,   none1, 0                        , iJG    },    /* 7F */
     {  immed,   data1, B                        , iINVALID    },    /* 80 */
     {  immed,   data2, NSP                      , iINVALID    },    /* 81 */
     {  immed,   data1, B                        , iINVALID    },    /* 82 */ /* ?? */
@@ -213,7 +210,7 @@ static const StateTabelEntry stateTable[] = {
     {  regop,   axImp, 0                        , iXCHG    },    /* 97 */
     {  alImp,   axImp, SRC_B | S_EXT            , iSIGNEX},    /* 98 */
     {axSrcIm,   axImp, IM_DST | S_EXT           , iSIGNEX},    /* 99 */
-    {  dispF,   none2, TO_REG                   , iCALLF },    /* 9A */ // TO_REG set to use SRC when processing setAddress
+    {  dispF,   none1, TO_REG                   , iCALLF },    /* 9A */ // TO_REG set to use SRC when processing setAddress
     {  none1,   none2, FLOAT_OP| NO_OPS         , iWAIT    },    /* 9B */
     {  none1,   none2, NOT_HLL | NO_OPS         , iPUSHF},    /* 9C */
     {  none1,   none2, NOT_HLL | NO_OPS         , iPOPF    },    /* 9D */
@@ -283,18 +280,18 @@ static const StateTabelEntry stateTable[] = {
     {  escop,   none2, FLOAT_OP                 , iESC    },    /* DD */
     {  escop,   none2, FLOAT_OP                 , iESC    },    /* DE */
     {  escop,   none2, FLOAT_OP                 , iESC    },    /* Df */
-    {  dispS,   none2, 0                        , iLOOPNE},    /* E0 */
-    {  dispS,   none2, 0                        , iLOOPE},    /* E1 */
-    {  dispS,   none2, 0                        , iLOOP    },    /* E2 */
-    {  dispS,   none2, 0                        , iJCXZ    },    /* E3 */
+    {  dispS,   none1, 0                        , iLOOPNE},    /* E0 */
+    {  dispS,   none1, 0                        , iLOOPE},    /* E1 */
+    {  dispS,   none1, 0                        , iLOOP    },    /* E2 */
+    {  dispS,   none1, 0                        , iJCXZ    },    /* E3 */
     {  data1,   axImp, NOT_HLL | B|NO_SRC       , iIN    },    /* E4 */
     {  data1,   axImp, NOT_HLL | NO_SRC         , iIN    },    /* E5 */
     {  data1,   axImp, NOT_HLL | B|NO_SRC       , iOUT    },    /* E6 */
     {  data1,   axImp, NOT_HLL | NO_SRC         , iOUT    },    /* E7 */
-    {  dispN,   none2, 0                        , iCALL    },    /* E8 */
-    {  dispN,   none2, 0                        , iJMP    },    /* E9 */
-    {  dispF,   none2, 0                        , iJMPF    },    /* EA */
-    {  dispS,   none2, 0                        , iJMP    },    /* EB */
+    {  dispN,   none1, 0                        , iCALL    },    /* E8 */
+    {  dispN,   none1, 0                        , iJMP    },    /* E9 */
+    {  dispF,   none1, 0                        , iJMPF    },    /* EA */
+    {  dispS,   none1, 0                        , iJMP    },    /* EB */
     {  none1,   axImp, NOT_HLL | B|NO_SRC       , iIN    },    /* EC */
     {  none1,   axImp, NOT_HLL | NO_SRC         , iIN    },    /* ED */
     {  none1,   axImp, NOT_HLL | B|NO_SRC       , iOUT    },    /* EE */
@@ -317,267 +314,170 @@ static const StateTabelEntry stateTable[] = {
     {  trans,   none1, NSP                      , iINVALID    }    /* FF */
 } ;
 
-static uint16_t    SegPrefix, RepPrefix;
-static const uint8_t  *pInst;        /* Ptr. to current uint8_t of instruction */
-static ICODE * pIcode;        /* Ptr to Icode record filled in by scan() */
-
-
-static void decodeBranchTgt(x86_insn_t &insn)
-{
-    x86_op_t *tgt_op = insn.x86_get_branch_target();
-    if(tgt_op->type==op_expression)
-        return; // unhandled for now
-    if(tgt_op->type==op_register)
-        return; // unhandled for now
-    int32_t addr = tgt_op->getAddress();
-    if(tgt_op->is_relative())
-    {
-        addr = (uint16_t)(addr + insn.addr + insn.size);
-    }
-    pIcode->ll()->replaceSrc((uint32_t)addr);
-    pIcode->ll()->setFlags(I);
-    //    PROG &prog(Project::get()->prog);
-    //    long off = (short)getWord();    /* Signed displacement */
-    //    assert(addr==(uint32_t)(off + (unsigned)(pInst - prog.image())));
-
-}
+/* Decoder state of scan(), per thread for the concurrent parser */
+static thread_local uint16_t    SegPrefix, RepPrefix;
+static thread_local const PROG *image;    /* Program being decoded */
+static thread_local uint32_t    pInst;        /* Image offset of current uint8_t of instruction */
+static thread_local ICODE * pIcode;        /* Ptr to Icode record filled in by scan() */
 
-static void convertUsedFlags(x86_insn_t &from,ICODE &to)
+/* Returns the current uint8_t of the instruction */
+static uint8_t peekByte()
 {
-    to.ll()->flagDU.d=0;
-    to.ll()->flagDU.u=0;
-    if(from.containsFlag(insn_eflag_carry,from.flags_set))
-        to.ll()->flagDU.d |= Cf;
-    if(from.containsFlag(insn_eflag_sign,from.flags_set))
-        to.ll()->flagDU.d |= Sf;
-    if(from.containsFlag(insn_eflag_zero,from.flags_set))
-        to.ll()->flagDU.d |= Zf;
-    if(from.containsFlag(insn_eflag_direction,from.flags_set))
-        to.ll()->flagDU.d |= Df;
-
-    if(from.containsFlag(insn_eflag_carry,from.flags_tested))
-        to.ll()->flagDU.u |= Cf;
-    if(from.containsFlag(insn_eflag_sign,from.flags_tested))
-        to.ll()->flagDU.u |= Sf;
-    if(from.containsFlag(insn_eflag_zero,from.flags_tested))
-        to.ll()->flagDU.u |= Zf;
-    if(from.containsFlag(insn_eflag_direction,from.flags_tested))
-        to.ll()->flagDU.u |= Df;
+    return image->byte(pInst);
 }
-static void convertPrefix(x86_insn_prefix prefix,ICODE &to)
+/* Returns the current uint8_t of the instruction and steps over it */
+static uint8_t getByte()
 {
-    if(prefix ==insn_no_prefix)
-        return;
-    // insn_lock - no need to handle
-    RepPrefix = (uint16_t)prefix & ~insn_lock;
+    return image->byte(pInst++);
 }
+
 /****************************************************************************
- Checks for int 34 to int 3B - if so, converts to ESC nn instruction
+ flagDefUse - condition flags defined and used by the decoded instruction.
+    Only the flags tracked by the data flow analysis are recorded.  String
+    instructions only record their use of Df, and byte sized STOS does not
+    record even that, which is what the data flow analysis has always been
+    given for them.
  ****************************************************************************/
-static void fixFloatEmulation(x86_insn_t &insn)
-{
-    if(insn.operand_count==0)
-        return;
-    if(insn.group!=x86_insn_t::insn_interrupt)
-        return;
-    PROG &prog(Project::get()->prog);
-    uint16_t wOp=insn.x86_get_imm()->data.word;
-    if ((wOp < 0x34) or (wOp > 0x3B))
-        return;
-    uint8_t buf[16];
-    /* This is a Borland/Microsoft floating point emulation instruction. Treat as if it is an ESC opcode */
-
-    int actual_valid_bytes=std::min(16U,prog.cbImage-insn.offset);
-    memcpy(buf,prog.image()+insn.offset,actual_valid_bytes);
-    X86_Disasm ds(opt_16_bit);
-    x86_insn_t patched_insn;
-    //patch actual instruction into buffer;
-    buf[1] = wOp-0x34+0xD8;
-    ds.x86_disasm(buf,actual_valid_bytes,0,1,&patched_insn);
-    patched_insn.addr   = insn.addr; // actual address
-    patched_insn.offset = insn.offset; // actual offset
-    insn = patched_insn;
-    insn.size += 1; // to account for emulator call INT
-}
-
-int disassembleOneLibDisasm(uint32_t ip,x86_insn_t &l)
+static DU flagDefUse(const LLInst &ll)
 {
-    PROG &prog(Project::get()->prog);
-    X86_Disasm ds(opt_16_bit);
-    int cnt=ds.x86_disasm(prog.image(),prog.cbImage,0,ip,&l);
-    if(cnt and l.is_valid())
+    const uint8_t CSZ = Cf | Sf | Zf;
+    switch (ll.getOpcode())
     {
-        fixFloatEmulation(l); //can change 'l'
+        case iADD:  case iAND:  case iCMP:  case iNEG:
+        case iOR:   case iSAHF: case iSAR:  case iSHL:
+        case iSHR:  case iSUB:  case iTEST: case iXOR:
+            return {CSZ, 0};
+        case iADC:  case iDAA:  case iDAS:  case iSBB:
+            return {CSZ, Cf};
+        case iAAA:  case iAAS:  case iCLC:  case iCMC:
+        case iIMUL: case iMUL:  case iROL:  case iROR:
+        case iSTC:
+            return {Cf, 0};
+        case iRCL:  case iRCR:
+            return {Cf, Cf};
+        case iAAD:  case iAAM:  case iDEC:  case iINC:
+            return {Sf | Zf, 0};
+        case iCLD:  case iSTD:
+            return {Df, 0};
+        case iIRET: case iPOPF:
+            return {CSZ | Df, 0};
+        case iPUSHF:
+            return {0, CSZ | Df};
+        case iJB:   case iJAE:
+            return {0, Cf};
+        case iJBE:  case iJA:
+            return {0, Cf | Zf};
+        case iJE:   case iJNE:  case iLOOPE: case iLOOPNE:
+            return {0, Zf};
+        case iJL:   case iJGE:  case iJS:   case iJNS:
+            return {0, Sf};
+        case iJLE:  case iJG:
+            return {0, Sf | Zf};
+        case iCMPS: case iREPNE_CMPS:   case iREPE_CMPS:
+        case iSCAS: case iREPNE_SCAS:   case iREPE_SCAS:
+        case iLODS: case iREP_LODS:
+        case iMOVS: case iREP_MOVS:
+            return {0, Df};
+        case iSTOS: case iREP_STOS:
+            if (ll.testFlags(B))
+                return {0, 0};
+            return {0, Df};
+        default:
+            return {0, 0};
     }
-    if(l.is_valid())
-        return l.size;
-    return 0;
-}
-eReg convertRegister(const x86_reg_t &reg)
-{
-    if( (reg_pc==reg.type) or (0==reg.id))
-        return rUNDEF;
-
-    eReg regmap[]={ rUNDEF,
-                    rUNDEF,rUNDEF,rUNDEF,rUNDEF,   //eax ecx ebx edx
-                    rSP,rUNDEF,rUNDEF,rDI,   //esp ebp esi edi
-                    rAX,rCX,rDX,rBX,
-                    rSP,rBP,rSI,rDI,
-                    rAL,rCL,rDL,rBL,
-                    rAH,rCH,rDH,rBH
-                  };
-    std::map<std::string,eReg> nameToEnum = {{"es",rES},{"ds",rDS},{"cs",rCS},{"ss",rSS}};
-    if(nameToEnum.find(reg.name)!=nameToEnum.end())
-        return nameToEnum[reg.name];
-    assert(reg.id<sizeof(regmap)/sizeof(eReg));
-    assert(regmap[reg.id]!=rUNDEF);
-    return regmap[reg.id];
 }
-LLOperand convertExpression(const x86_ea_t &from)
+
+/****************************************************************************
+ escFlagDefUse - condition flags defined and used by coprocessor instruction
+    i (D8..DF) with the given modrm byte: the comparisons that set the CPU
+    flags and the FCMOVcc family.
+ ****************************************************************************/
+static DU escFlagDefUse(int i, uint8_t modrm)
 {
-    // BASE + Scale*Index + Disp
-    LLOperand res;
-    res.seg = rDS;
-    /*
-    INDEX_BX_SI = 22, // "bx+si"
-    INDEX_BX_DI, // "bx+di"
-    INDEX_BP_SI, // "bp+si"
-    INDEX_BP_DI, // "bp+di"
-    INDEX_SI, // "si"
-    INDEX_DI, // "di"
-    INDEX_BP, // "bp"
-    INDEX_BX, // "bx"
-    */
-    if(from.base.id)
+    bool regForm = (modrm & 0xC0) == 0xC0;
+    switch (i)
     {
-        eReg base_reg = convertRegister(from.base);
-        eReg index_reg = convertRegister(from.index);
-        //        if(base_reg==rBX)
-        switch(base_reg)
-        {
-            case rDI:
-                res.regi = INDEX_DI; break;
-            case rBP:
-                res.seg=rSS;
-                switch(index_reg)
-                {
-                    case rDI:
-                        res.regi = INDEX_BP_DI; break;
-                    case rSI:
-                        res.regi = INDEX_BP_SI; break;
-                    case rUNDEF:
-                        res.regi = INDEX_BP; break;
-                    default:
-                        assert(false);
-                }
-                break;
-            case rBX:
-                switch(index_reg)
-                {
-                    case rDI:
-                        res.regi = INDEX_BX_DI; break;
-                    case rSI:
-                        res.regi = INDEX_BX_SI; break;
-                    case rUNDEF:
-                        res.regi = INDEX_BX; break;
-                    default:
-                        assert(false);
-                }
+        case 0xD8:                              /* FCOM, FCOMP */
+            if (REG(modrm) == 2 or REG(modrm) == 3)
+                return {Cf | Zf, 0};
+            break;
+        case 0xDC:                              /* FCOM, FCOMP m64 */
+            if (not regForm and (REG(modrm) == 2 or REG(modrm) == 3))
+                return {Cf | Zf, 0};
+            break;
+        case 0xDA: case 0xDB:                   /* FCMOVcc, FCOMI */
+            if (not regForm)
                 break;
-            default:
-                assert(false);
-        }
-        assert(index_reg==rUNDEF);
-    }
-    assert(from.scale==0);
-    if(from.index.id)
-    {
-        assert(false);
-    }
-    res.off = from.disp;
-    return res;
-}
-LLOperand convertOperand(const x86_op_t &from)
-{
-    LLOperand res;
-    switch(from.type)
-    {
-        case op_unused:
+            switch (REG(modrm))
+            {
+                case 0: return {0, Cf};
+                case 1: return {0, Zf};
+                case 2: return {0, Cf | Zf};
+                case 6: if (i == 0xDB) return {Cf | Zf, 0};
+            }
             break;
-        case op_register:
-            res.regi = convertRegister(from.data.reg); break;
-        case op_immediate:
-            res.opz = from.data.sdword; break;
-        case op_expression:
-            res = convertExpression(from.data.expression); break;
-        case op_offset:
-        {
-            LLOperand res;
-            res.seg = rDS;
-            res.off = from.data.offset;
+        case 0xDF:                              /* FCOMIP */
+            if (regForm and REG(modrm) == 6)
+                return {Cf | Zf, 0};
             break;
-        }
-        default:
-            fprintf(stderr,"convertOperand does not know how to convert %d\n",from.type);
     }
-    if(res.isSet() and (res.seg == rUNDEF))
-    {
-        res.seg = rDS;
-    }
-    return res;
+    return {0, 0};
 }
+
+
 /*****************************************************************************
- Scans one machine instruction at offset ip in prog.Image and returns error.
+ Scans one machine instruction at offset ip in the program image and returns error.
  At the same time, fill in low-level icode details for the scanned inst.
+ Instructions found in the project's DecodeCache are not decoded again.
  ****************************************************************************/
 
 eErrorId scan(uint32_t ip, ICODE &p)
 {
-    PROG &prog(Project::get()->prog);
+    eErrorId err;
+    if (Project::get()->decoded.lookup(ip, p, err))
+        return err;
+    return decode(ip, p);
+}
+
+/*****************************************************************************
+ predecode - Fills the project's DecodeCache with a sweep over the image
+ ****************************************************************************/
+void predecode(int jobs)
+{
+    Project::get()->decoded.build(Project::get()->prog.cbImage, jobs, decode);
+}
+
+static eErrorId decode(uint32_t ip, ICODE &p)
+{
     int  op;
     p = ICODE();
     p.type = LOW_LEVEL_ICODE;
     p.ll()->label = ip;            /* ip is absolute offset into image*/
-    if (ip >= (uint32_t)prog.cbImage)
+    image = &Project::get()->prog;
+    if (ip >= (uint32_t)image->cbImage)
     {
         return (IP_OUT_OF_RANGE);
     }
-    int cnt=disassembleOneLibDisasm(ip,p.insn);
-
     SegPrefix = RepPrefix = 0;
-
-    if(cnt)
-    {
-        convertUsedFlags(p.insn,p);
-        convertPrefix(p.insn.prefix,p);
-    }
-
-    pInst    = prog.image() + ip;
+    pInst    = ip;
     pIcode   = &p;
 
     do
     {
-        op = *pInst++;                        /* First state - trivial   */
+        op = getByte();                        /* First state - trivial   */
         /* Convert to Icode.opcode */
         p.ll()->set(stateTable[op].opcode,stateTable[op].flg & ICODEMASK);
         (*stateTable[op].state1)(op);        /* Second state */
         (*stateTable[op].state2)(op);        /* Third state  */
 
     } while (stateTable[op].state1 == prefix);    /* Loop if prefix */
-    if(p.insn.group == x86_insn_t::insn_controlflow)
-    {
-        if(p.insn.x86_get_branch_target())
-            decodeBranchTgt(p.insn);
-    }
-    //    LLOperand conv = convertOperand(*p.insn.get_dest());
-    //    assert(conv==p.ll()->dst);
+
+    if (not p.ll()->match(iESC))    /* escop() already set these */
+        p.ll()->flagDU = flagDefUse(*p.ll());
     if (p.ll()->getOpcode()!=iINVALID)
     {
         /* Save bytes of image used */
-        p.ll()->numBytes = (uint8_t)((pInst - prog.image()) - ip);
-        if(p.insn.is_valid())
-            assert(p.ll()->numBytes == p.insn.size);
-        p.ll()->numBytes = p.insn.size;
+        p.ll()->numBytes = (uint8_t)(pInst - ip);
         return ((SegPrefix)? FUNNY_SEGOVR:  /* Seg. Override invalid */
                              (RepPrefix ? FUNNY_REP: NO_ERR));/* REP prefix invalid */
     }
@@ -588,16 +488,9 @@ eErrorId scan(uint32_t ip, ICODE &p)
 /***************************************************************************
  relocItem - returns true if uint16_t pointed at is in relocation table
  **************************************************************************/
-static bool relocItem(const uint8_t *p)
+static bool relocItem(uint32_t off)
 {
-    PROG &prog(Project::get()->prog);
-    int        i;
-    uint32_t    off = p - prog.image();
-
-    for (i = 0; i < prog.cReloc; i++)
-        if (prog.relocTable[i] == off)
-            return true;
-    return false;
+    return image->isRelocated(off);
 }
 
 
@@ -606,7 +499,7 @@ static bool relocItem(const uint8_t *p)
  **************************************************************************/
 static uint16_t getWord()
 {
-    uint16_t w = LH(pInst);
+    uint16_t w = image->word(pInst);
     pInst += 2;
     return w;
 }
@@ -670,8 +563,8 @@ static void setAddress(int i, bool fdst, uint16_t seg, int16_t reg, uint16_t off
  ***************************************************************************/
 static void rm(int i)
 {
-    uint8_t mod = *pInst >> 6;
-    uint8_t rm  = *pInst++ & 7;
+    uint8_t mod = peekByte() >> 6;
+    uint8_t rm  = getByte() & 7;
 
     switch (mod) {
         case 0:        /* No disp unless rm == 6 */
@@ -684,7 +577,7 @@ static void rm(int i)
             break;
 
         case 1:        /* 1 uint8_t disp */
-            setAddress(i, true, SegPrefix, rm+INDEX_BX_SI, (uint16_t)signex(*pInst++));
+            setAddress(i, true, SegPrefix, rm+INDEX_BX_SI, (uint16_t)signex(getByte()));
             break;
 
         case 2:        /* 2 uint8_t disp */
@@ -696,7 +589,6 @@ static void rm(int i)
             setAddress(i, true, 0, rm + rAX, 0);
             break;
     }
-    //pIcode->insn.get_dest()->
     if ((stateTable[i].flg & NSP) and (pIcode->ll()->src().getReg2()==rSP or
                                       pIcode->ll()->m_dst.getReg2()==rSP))
         pIcode->ll()->setFlags(NOT_HLL);
@@ -708,7 +600,7 @@ static void rm(int i)
  ***************************************************************************/
 static void modrm(int i)
 {
-    setAddress(i, false, 0, REG(*pInst) + rAX, 0);
+    setAddress(i, false, 0, REG(peekByte()) + rAX, 0);
     rm(i);
 }
 
@@ -718,7 +610,7 @@ static void modrm(int i)
  ****************************************************************************/
 static void segrm(int i)
 {
-    int    reg = REG(*pInst) + rES;
+    int    reg = REG(peekByte()) + rES;
 
     if (reg > rDS or (reg == rCS and (stateTable[i].flg & TO_REG)))
         pIcode->ll()->setOpcode((llIcode)0); // setCBW because it has that index
@@ -786,7 +678,7 @@ static void memImp(int i)
  ***************************************************************************/
 static void memOnly(int )
 {
-    if ((*pInst & 0xC0) == 0xC0)
+    if ((peekByte() & 0xC0) == 0xC0)
         pIcode->ll()->setOpcode(iINVALID);
 }
 
@@ -796,7 +688,7 @@ static void memOnly(int )
  ****************************************************************************/
 static void memReg0(int i)
 {
-    if (REG(*pInst) or (*pInst & 0xC0) == 0xC0)
+    if (REG(peekByte()) or (peekByte() & 0xC0) == 0xC0)
         pIcode->ll()->setOpcode(iINVALID);
     else
         rm(i);
@@ -810,7 +702,7 @@ static void immed(int i)
 {
     static llIcode immedTable[8] = {iADD, iOR, iADC, iSBB, iAND, iSUB, iXOR, iCMP};
 
-    pIcode->ll()->setOpcode(immedTable[REG(*pInst)]) ;
+    pIcode->ll()->setOpcode(immedTable[REG(peekByte())]) ;
     rm(i);
 
     if (pIcode->ll()->getOpcode() == iADD or pIcode->ll()->getOpcode() == iSUB)
@@ -828,7 +720,7 @@ static void shift(int i)
         (llIcode)iROL, (llIcode)iROR, (llIcode)iRCL, (llIcode)iRCR,
         (llIcode)iSHL, (llIcode)iSHR, (llIcode)0,     (llIcode)iSAR};
 
-    pIcode->ll()->setOpcode(shiftTable[REG(*pInst)]);
+    pIcode->ll()->setOpcode(shiftTable[REG(peekByte())]);
     rm(i);
     pIcode->ll()->replaceSrc(rCL); //src.regi =
 }
@@ -845,11 +737,11 @@ static void trans(int i)
         iJMP, iJMPF,iPUSH, (llIcode)0
     };
     LLInst *ll = pIcode->ll();
-//    if(transTable[REG(*pInst)]==iPUSH) {
+//    if(transTable[REG(peekByte())]==iPUSH) {
 //        printf("es");
 //    }
-    if ((uint8_t)REG(*pInst) < 2 or not (stateTable[i].flg & B)) { /* INC & DEC */
-        ll->setOpcode(transTable[REG(*pInst)]);   /* valid on bytes */
+    if ((uint8_t)REG(peekByte()) < 2 or not (stateTable[i].flg & B)) { /* INC & DEC */
+        ll->setOpcode(transTable[REG(peekByte())]);   /* valid on bytes */
         rm(i);
         ll->replaceSrc( pIcode->ll()->m_dst );
         if (ll->match(iJMP) or ll->match(iCALL) or ll->match(iCALLF))
@@ -871,7 +763,7 @@ static void arith(int i)
         iTEST,  iINVALID, iNOT, iNEG,
         iMUL ,  iIMUL, iDIV, iIDIV
     };
-    opcode = arithTable[REG(*pInst)];
+    opcode = arithTable[REG(peekByte())];
     pIcode->ll()->setOpcode((llIcode)opcode);
     rm(i);
     if (opcode == iTEST)
@@ -902,7 +794,7 @@ static void arith(int i)
  *****************************************************************************/
 static void data1(int i)
 {
-    pIcode->ll()->replaceSrc(LLOperand::CreateImm2((stateTable[i].flg & S_EXT)? signex(*pInst++): *pInst++,1));
+    pIcode->ll()->replaceSrc(LLOperand::CreateImm2((stateTable[i].flg & S_EXT)? signex(getByte()): getByte(),1));
     pIcode->ll()->setFlags(I);
 }
 
@@ -939,19 +831,28 @@ static void dispM(int i)
 {
     setAddress(i, false, SegPrefix, 0, getWord());
 }
+/****************************************************************************
+ branchTgt - Sets the immediate src to the target of a direct jump or call.
+    Note: the target is relative to ip, and the result of the addition could
+    be between 32k and 64k and still be positive; it is an offset from
+    prog.Image, so it is treated as unsigned.
+    The disp* entries of stateTable use none1 as their third state, the
+    target is an operand of the jump and must not turn it into NO_OPS.
+ ****************************************************************************/
+static void branchTgt(uint32_t tgt)
+{
+    pIcode->ll()->replaceSrc(tgt);
+    pIcode->ll()->setFlags(I);
+}
+
 /****************************************************************************
  dispN - 2 uint8_t disp as immed relative to ip
  ****************************************************************************/
 static void dispN(int )
 {
+    long off = (short)getWord();    /* Signed displacement */
 
-    //PROG &prog(Project::get()->prog);
-    /*long off = (short)*/getWord();    /* Signed displacement */
-
-    /* Note: the result of the subtraction could be between 32k and 64k, and
-        still be positive; it is an offset from prog.Image. So this must be
-        treated as unsigned */
-    //    decodeBranchTgt();
+    branchTgt((uint16_t)(off + pInst));
 }
 
 
@@ -960,9 +861,9 @@ static void dispN(int )
  ***************************************************************************/
 static void dispS(int )
 {
-    /*long off =*/ signex(*pInst++);     /* Signed displacement */
+    long off = signex(getByte());     /* Signed displacement */
 
-    //    decodeBranchTgt();
+    branchTgt((uint16_t)(off + pInst));
 }
 
 
@@ -975,7 +876,7 @@ static void dispF(int i)
     uint16_t seg = (unsigned)getWord();
     // FIXME: this is wrong since seg here is seg value, but setAddress treats it as register id
     setAddress(i, true, seg, 0, off);
-    //    decodeBranchTgt();
+    branchTgt(((uint32_t)seg << 4) + off);
 }
 
 
@@ -1007,16 +908,16 @@ static void strop(int )
     {
         if ( pIcode->ll()->match(iCMPS) or pIcode->ll()->match(iSCAS) )
         {
-            if(pIcode->insn.prefix &  insn_rep_zero)
+            if (RepPrefix == iREPE)
             {
                 BumpOpcode(*pIcode->ll()); // iCMPS -> iREPE_CMPS
                 BumpOpcode(*pIcode->ll());
             }
-            else if(pIcode->insn.prefix &  insn_rep_notzero)
+            else
                 BumpOpcode(*pIcode->ll()); // iX -> iREPNE_X
         }
         else
-            if(pIcode->insn.prefix &  insn_rep_zero)
+            if (RepPrefix == iREPE)
                 BumpOpcode(*pIcode->ll()); // iX -> iREPE_X
         if (pIcode->ll()->match(iREP_LODS) )
             pIcode->ll()->setFlags(NOT_HLL);
@@ -1030,8 +931,9 @@ static void strop(int )
  ***************************************************************************/
 static void escop(int i)
 {
-    pIcode->ll()->replaceSrc(REG(*pInst) + (uint32_t)((i & 7) << 3));
+    pIcode->ll()->replaceSrc(REG(peekByte()) + (uint32_t)((i & 7) << 3));
     pIcode->ll()->setFlags(I);
+    pIcode->ll()->flagDU = escFlagDefUse(i, peekByte());
     rm(i);
 }
 
@@ -168,6 +168,14 @@ SYM * SYMTAB::updateGlobSym (uint32_t operand, int size, uint16_t duFlag,bool &i
     }
 
     /* New symbol, not in symbol table */
+    push_back(newGlobSym(operand, size, duFlag));
+    inserted_new=true;
+    return &back();
+}
+
+/* The entry updateGlobSym creates for a variable that is not in the table */
+SYM SYMTAB::newGlobSym(uint32_t operand, int size, uint16_t duFlag)
+{
     SYM v;
     char buf[32]={};
     sprintf (buf, "var%05X", operand);
@@ -184,9 +192,7 @@ SYM * SYMTAB::updateGlobSym (uint32_t operand, int size, uint16_t duFlag,bool &i
     {
         v.duVal.setFlags(duFlag);
     }
-    push_back(v);
-    inserted_new=true;
-    return &back();
+    return v;
 }
 
 //template<> class SymbolTableCommon<SYM>;
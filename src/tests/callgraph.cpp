@@ -0,0 +1,29 @@
+#include "project.h"
+#include "CallGraph.h"
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+TEST(CallGraph, ComponentsAreOrderedBottomUp) {
+    Project p;
+    ilFunction start = p.createFunction(0,"start",0x100);
+    ilFunction a     = p.createFunction(0,"a",0x200);
+    ilFunction b     = p.createFunction(0,"b",0x300);
+    ilFunction leaf  = p.createFunction(0,"leaf",0x400);
+    CALL_GRAPH cg(start);
+    EXPECT_FALSE(cg.insertCallGraph(a,b)); // caller not in graph yet
+    EXPECT_TRUE(cg.insertCallGraph(start,a));
+    EXPECT_TRUE(cg.insertCallGraph(a,b));
+    EXPECT_TRUE(cg.insertCallGraph(b,a));
+    EXPECT_TRUE(cg.insertCallGraph(b,leaf));
+    EXPECT_TRUE(cg.insertCallGraph(a,b));  // duplicate arc is ignored
+    ASSERT_EQ(4U,cg.size());
+    int ia = cg.findNode(&(*a));
+    EXPECT_EQ(1U,cg.node(ia).outEdges.size());
+    EXPECT_EQ(2U,cg.node(ia).inEdges.size());
+
+    std::vector<CALL_GRAPH::Component> sccs = cg.stronglyConnectedComponents();
+    ASSERT_EQ(3U,sccs.size());
+    EXPECT_EQ(std::vector<int>{cg.findNode(&(*leaf))},sccs[0]);
+    EXPECT_EQ(2U,sccs[1].size());
+    EXPECT_EQ(std::vector<int>{cg.root()},sccs[2]);
+}
@@ -0,0 +1,50 @@
+#include "ChunkedVector.h"
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+TEST(ChunkedVector, NewContainerIsEmpty) {
+    ChunkedVector<int> v;
+    EXPECT_TRUE(v.empty());
+    EXPECT_EQ(0u,v.size());
+    EXPECT_TRUE(v.begin()==v.end());
+}
+
+TEST(ChunkedVector, AddressesAndIteratorsSurviveGrowth) {
+    ChunkedVector<int> v;
+    v.push_back(0);
+    int *first = &v.front();
+    ChunkedVector<int>::iterator first_iter = v.begin();
+    ChunkedVector<int>::iterator end_iter = v.end();
+    for(int i=1; i<2000; ++i)
+        v.push_back(i);
+    EXPECT_EQ(first,&v.front());
+    EXPECT_EQ(0,*first_iter);
+    EXPECT_TRUE(end_iter==v.end());
+    EXPECT_EQ(1999,v[1999]);
+    EXPECT_EQ(2000,std::distance(v.begin(),v.end()));
+}
+
+TEST(ChunkedVector, IteratorToLastElementSeesAppendedElements) {
+    ChunkedVector<int> v;
+    v.push_back(1);
+    ChunkedVector<int>::iterator last = (++v.rbegin()).base();
+    v.push_back(2);
+    ++last;
+    ASSERT_TRUE(last!=v.end());
+    EXPECT_EQ(2,*last);
+    ++last;
+    EXPECT_TRUE(last==v.end());
+}
+
+TEST(ChunkedVector, CopyIsIndependent) {
+    ChunkedVector<int> v;
+    for(int i=0; i<300; ++i)
+        v.push_back(i);
+    ChunkedVector<int> c(v);
+    c[10] = -1;
+    EXPECT_EQ(10,v[10]);
+    EXPECT_EQ(300u,c.size());
+    c.clear();
+    EXPECT_TRUE(c.empty());
+    EXPECT_EQ(299,v.back());
+}
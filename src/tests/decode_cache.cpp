@@ -0,0 +1,85 @@
+#include "DecodeCache.h"
+#include <gtest/gtest.h>
+
+/* Stand-in for the scanner: instruction lengths cycle through 1..3, and
+ * every 10th byte is an invalid opcode */
+static eErrorId fakeDecode(uint32_t ip, ICODE &p)
+{
+    p = ICODE();
+    p.type = LOW_LEVEL_ICODE;
+    p.ll()->label = ip;
+    if (ip % 10 == 9)
+        return INVALID_OPCODE;
+    p.ll()->numBytes = 1 + ip % 3;
+    return NO_ERR;
+}
+
+TEST(DecodeCache, LookupMatchesDecoder) {
+    for (int jobs : {1, 4}) {
+        DecodeCache cache;
+        cache.build(5*DecodeCache::MIN_CHUNK, jobs, fakeDecode);
+        EXPECT_FALSE(cache.empty());
+        ICODE cached, fresh;
+        eErrorId err;
+        size_t hits = 0;
+        for (uint32_t ip = 0; ip < 5*DecodeCache::MIN_CHUNK; ++ip) {
+            if (not cache.lookup(ip, cached, err))
+                continue;
+            ++hits;
+            EXPECT_EQ(fakeDecode(ip, fresh), err);
+            EXPECT_EQ(fresh.ll()->label, cached.ll()->label);
+            EXPECT_EQ(fresh.ll()->numBytes, cached.ll()->numBytes);
+        }
+        EXPECT_EQ(cache.size(), hits);
+        /* the sweep starts at 0 and steps over each instruction */
+        EXPECT_TRUE(cache.lookup(0, cached, err));
+        EXPECT_TRUE(cache.lookup(1, cached, err));
+        EXPECT_FALSE(cache.lookup(2, cached, err));
+        EXPECT_FALSE(cache.lookup(5*DecodeCache::MIN_CHUNK, cached, err));
+    }
+}
+
+TEST(DecodeCache, InvalidateDropsOverlappingInstructions) {
+    DecodeCache cache;
+    cache.build(64, 1, fakeDecode);
+    ICODE ic;
+    eErrorId err;
+    /* instructions at 1 (1..2), 3 (3) and 4 (4..5) */
+    ASSERT_TRUE(cache.lookup(1, ic, err));
+    ASSERT_TRUE(cache.lookup(3, ic, err));
+    ASSERT_TRUE(cache.lookup(4, ic, err));
+    size_t before = cache.size();
+    cache.invalidate(2, 2);
+    EXPECT_FALSE(cache.lookup(1, ic, err));
+    EXPECT_FALSE(cache.lookup(3, ic, err));
+    EXPECT_TRUE(cache.lookup(4, ic, err));
+    EXPECT_EQ(before-2, cache.size());
+    cache.clear();
+    EXPECT_TRUE(cache.empty());
+    EXPECT_FALSE(cache.lookup(4, ic, err));
+}
+
+/* Every 8th byte starts a 3 byte direct call to one of five targets, the
+ * bytes in between are 1 byte instructions */
+static eErrorId fakeCallDecode(uint32_t ip, ICODE &p)
+{
+    p = ICODE();
+    p.type = LOW_LEVEL_ICODE;
+    p.ll()->label = ip;
+    p.ll()->numBytes = 1;
+    if (ip % 8 == 0) {
+        p.ll()->set(iCALL, I);
+        p.ll()->replaceSrc(LLOperand::CreateImm2(1000 + 100*(ip/8 % 5)));
+        p.ll()->numBytes = 3;
+    }
+    return NO_ERR;
+}
+
+TEST(DecodeCache, CallTargetsAreSortedAndUnique) {
+    DecodeCache cache;
+    cache.build(256, 1, fakeCallDecode);
+    EXPECT_EQ((std::vector<uint32_t>{1000, 1100, 1200, 1300, 1400}), cache.callTargets());
+    /* the calls left are at 224, 232, 240 and 248 */
+    cache.invalidate(0, 224);
+    EXPECT_EQ((std::vector<uint32_t>{1000, 1100, 1300, 1400}), cache.callTargets());
+}
@@ -0,0 +1,53 @@
+#include "project.h"
+#include <gtest/gtest.h>
+
+/* The updates of udm -j workers, applied in procedure order, leave the
+ * procedures as a sequential run would */
+struct DeferredUpdatesTest : public ::testing::Test {
+    Project p;
+    Function *caller, *callee;
+    void SetUp() override {
+        caller = &*p.createFunction(0,"caller",0x100);
+        callee = &*p.createFunction(0,"callee",0x200);
+    }
+    void defer() {
+        caller->m_deferred = new DeferredUpdates;
+        callee->m_deferred = new DeferredUpdates;
+    }
+    void apply() {
+        caller->applyDeferredUpdates();
+        callee->applyDeferredUpdates();
+    }
+};
+
+TEST_F(DeferredUpdatesTest, ParamCheckFollowsTheCallersCallInfo) {
+    /* The caller pops 6 bytes, the callee's frame holds 4 */
+    for (bool deferred : {false, true}) {
+        callee->cbParam = 0;
+        callee->callingConv(CConv::eUnknown);
+        if (deferred)
+            defer();
+        caller->setCallInfo(callee, 6, CConv::eCdecl);
+        callee->checkParamBytes(4);
+        if (deferred)
+            apply();
+        EXPECT_EQ(4, callee->cbParam);
+        EXPECT_EQ(CConv::create(CConv::eUnknown), callee->callingConv());
+    }
+}
+
+TEST_F(DeferredUpdatesTest, ParamCheckKeepsTheConventionOfItsOwnIdioms) {
+    /* RET 4 of a procedure whose frame holds 4 bytes of parameters */
+    for (bool deferred : {false, true}) {
+        callee->cbParam = 0;
+        callee->callingConv(CConv::eUnknown);
+        if (deferred)
+            defer();
+        callee->setCallInfo(callee, 4, CConv::ePascal);
+        callee->checkParamBytes(4);
+        if (deferred)
+            apply();
+        EXPECT_EQ(4, callee->cbParam);
+        EXPECT_EQ(CConv::create(CConv::ePascal), callee->callingConv());
+    }
+}
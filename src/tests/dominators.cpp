@@ -0,0 +1,50 @@
+#include "DominatorTree.h"
+#include <gtest/gtest.h>
+
+namespace {
+/* Builds the compressed predecessor lists out of (from,to) edges */
+void buildTree(DominatorTree &tree, size_t numNodes, const std::vector<std::pair<int,int>> &edges)
+{
+    std::vector<std::vector<int>> preds(numNodes);
+    for(const std::pair<int,int> &e : edges)
+        preds[e.second].push_back(e.first);
+    std::vector<int> predStart, predList;
+    for(const std::vector<int> &p : preds) {
+        predStart.push_back(predList.size());
+        predList.insert(predList.end(),p.begin(),p.end());
+    }
+    predStart.push_back(predList.size());
+    tree.build(0,predStart,predList);
+}
+}
+
+TEST(DominatorTree, DiamondWithLoop) {
+    /* 0 -> 1,2 ; 1,2 -> 3 ; 3 -> 4 ; 4 -> 3 (back edge) ; 4 -> 5 */
+    DominatorTree tree;
+    buildTree(tree,6,{{0,1},{0,2},{1,3},{2,3},{3,4},{4,3},{4,5}});
+    EXPECT_EQ(DominatorTree::UNDEFINED,tree.immedDom(0));
+    EXPECT_EQ(0,tree.immedDom(1));
+    EXPECT_EQ(0,tree.immedDom(2));
+    EXPECT_EQ(0,tree.immedDom(3));
+    EXPECT_EQ(3,tree.immedDom(4));
+    EXPECT_EQ(4,tree.immedDom(5));
+    std::vector<int> children(tree.children(0).begin(),tree.children(0).end());
+    EXPECT_EQ(std::vector<int>({1,2,3}),children);
+    EXPECT_TRUE(tree.dominates(3,5));
+    EXPECT_TRUE(tree.dominates(5,5));
+    EXPECT_FALSE(tree.dominates(1,3));
+    EXPECT_FALSE(tree.dominates(5,3));
+}
+
+TEST(DominatorTree, IrreducibleAndUnreachableNodes) {
+    /* 1 and 2 form a loop with two entries; 4 is unreachable */
+    DominatorTree tree;
+    buildTree(tree,5,{{0,1},{0,2},{1,2},{2,1},{2,3},{4,3}});
+    EXPECT_EQ(0,tree.immedDom(1));
+    EXPECT_EQ(0,tree.immedDom(2));
+    EXPECT_EQ(2,tree.immedDom(3));
+    EXPECT_FALSE(tree.reachable(4));
+    EXPECT_EQ(DominatorTree::UNDEFINED,tree.immedDom(4));
+    EXPECT_FALSE(tree.dominates(4,3));
+    EXPECT_FALSE(tree.dominates(1,2));
+}
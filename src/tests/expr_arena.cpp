@@ -0,0 +1,44 @@
+#include "ast.h"
+#include <gtest/gtest.h>
+
+TEST(ExprArena, ConstantsAreSharedWithinScope) {
+    ExprArena arena;
+    ExprArena::Scope scope(arena);
+    Constant *a = Constant::Create(2,2);
+    Constant *b = Constant::Create(2,2);
+    EXPECT_EQ(a,b);
+    EXPECT_TRUE(ExprArena::isShared(a));
+    EXPECT_NE(a,Constant::Create(2,1));
+    EXPECT_EQ(a,a->clone());
+    /* both operands may be the same shared leaf */
+    Expr *sum = BinaryOperator::CreateAdd(a,b->clone());
+    Expr::destroy(sum);
+    EXPECT_EQ(2u,a->kte.kte);
+    EXPECT_EQ(a,Constant::Create(2,2));
+}
+
+TEST(ExprArena, DeletedNodesAreReused) {
+    ExprArena arena;
+    ExprArena::Scope scope(arena);
+    Expr *tree = UnaryOperator::Create(NEGATION,AstIdent::LongIdx(1));
+    EXPECT_EQ(2u,arena.size());
+    Expr *copy = tree->clone();
+    EXPECT_EQ(4u,arena.size());
+    Expr::destroy(copy);
+    EXPECT_EQ(2u,arena.size());
+    Expr *other = tree->clone();
+    EXPECT_EQ(4u,arena.size());
+    Expr::destroy(other);
+    arena.release();
+    EXPECT_EQ(0u,arena.size());
+}
+
+TEST(ExprArena, NoScopeMeansHeap) {
+    EXPECT_EQ(nullptr,ExprArena::current());
+    Constant *a = Constant::Create(7,2);
+    Constant *b = Constant::Create(7,2);
+    EXPECT_NE(a,b);
+    EXPECT_FALSE(ExprArena::isShared(a));
+    Expr::destroy(a);
+    Expr::destroy(b);
+}
@@ -12,3 +12,48 @@ TEST(Loader, NewProjectIsInitalized) {
     ASSERT_TRUE(p.symtab.empty());
 }
 
+
+TEST(Loader, ImageSuppliesPspAndFixups) {
+    const uint8_t module[] = {0x90, 0x34, 0x12, 0xF8, 0xFF, 0xC3};
+    PROG prog;
+    prog.cbImage = PROG::PSP_SIZE + sizeof(module);
+    prog.module = module;
+    prog.relocBase = 0x10;
+    prog.relocTable = {PROG::PSP_SIZE+1, PROG::PSP_SIZE+3};
+    prog.indexRelocations();
+    EXPECT_EQ(0xCD,prog.byte(0));
+    EXPECT_EQ(0x20,prog.byte(1));
+    EXPECT_EQ(0,prog.byte(2));
+    EXPECT_EQ(0x90,prog.byte(PROG::PSP_SIZE));
+    EXPECT_EQ(0x1244,prog.word(PROG::PSP_SIZE+1));
+    /* the fixup carries into the high byte */
+    EXPECT_EQ(0x0008,prog.word(PROG::PSP_SIZE+3));
+    EXPECT_EQ(0x08,prog.byte(PROG::PSP_SIZE+3));
+    EXPECT_EQ(0x00,prog.byte(PROG::PSP_SIZE+4));
+    EXPECT_EQ(0xC3,prog.byte(PROG::PSP_SIZE+5));
+    EXPECT_EQ(0,prog.byte(prog.cbImage));
+    /* the mapped module itself is left alone */
+    EXPECT_EQ(0x34,module[1]);
+    EXPECT_EQ(0xF8,module[3]);
+}
+
+TEST(Loader, AdjacentFixupsBothApply) {
+    /* The words at 1 and at 2 overlap: both fixups change the byte at 2,
+     * and the second one carries into the byte at 3 */
+    const uint8_t module[] = {0x90, 0x34, 0xF8, 0x12, 0xC3};
+    PROG prog;
+    prog.cbImage = PROG::PSP_SIZE + sizeof(module);
+    prog.module = module;
+    prog.relocBase = 0x10;
+    prog.relocTable = {PROG::PSP_SIZE+1, PROG::PSP_SIZE+2};
+    prog.indexRelocations();
+    EXPECT_EQ(0x90,prog.byte(PROG::PSP_SIZE));
+    EXPECT_EQ(0x44,prog.byte(PROG::PSP_SIZE+1));
+    EXPECT_EQ(0x08,prog.byte(PROG::PSP_SIZE+2));
+    EXPECT_EQ(0x13,prog.byte(PROG::PSP_SIZE+3));
+    EXPECT_EQ(0xC3,prog.byte(PROG::PSP_SIZE+4));
+    EXPECT_EQ(0x0844,prog.word(PROG::PSP_SIZE+1));
+    EXPECT_EQ(0x1308,prog.word(PROG::PSP_SIZE+2));
+    EXPECT_EQ(0x34,module[1]);
+    EXPECT_EQ(0xF8,module[2]);
+}
@@ -0,0 +1,52 @@
+#include "MemoryMap.h"
+#include "dcc.h"
+#include <gtest/gtest.h>
+
+TEST(MemoryMap, SetJoinsRunsWithTheSameBits) {
+    MemoryMap map;
+    map.reset(100);
+    EXPECT_EQ(1u,map.runCount());
+    map.set(10, 5, BM_CODE);
+    map.set(15, 5, BM_CODE);
+    EXPECT_EQ(3u,map.runCount());
+    EXPECT_EQ(BM_UNKNOWN,map.at(9));
+    EXPECT_EQ(BM_CODE,map.at(10));
+    EXPECT_EQ(BM_CODE,map.at(19));
+    EXPECT_EQ(20u,map.runEnd(10));
+    /* code that is also data is impure */
+    map.set(18, 4, BM_DATA);
+    EXPECT_EQ(BM_IMPURE,map.at(19));
+    EXPECT_EQ(BM_DATA,map.at(21));
+    EXPECT_EQ(BM_UNKNOWN,map.at(22));
+    /* clipped to the map */
+    map.set(90, 50, BM_DATA);
+    EXPECT_EQ(BM_DATA,map.at(99));
+    EXPECT_EQ(0,map.at(100));
+    /* code, impure, code, impure */
+    map.set(0, 100, BM_CODE);
+    EXPECT_EQ(4u,map.runCount());
+    EXPECT_EQ(BM_IMPURE,map.at(21));
+}
+
+TEST(MemoryMap, RangeQueriesAndRegions) {
+    MemoryMap map;
+    map.reset(64);
+    map.set(8, 8, BM_CODE);
+    map.set(32, 4, BM_DATA);
+    EXPECT_TRUE(map.any(0, 9, BM_CODE));
+    EXPECT_FALSE(map.any(0, 8, BM_CODE));
+    EXPECT_FALSE(map.any(16, 16, BM_CODE | BM_DATA));
+    EXPECT_TRUE(map.any(30, 100, BM_DATA));
+    EXPECT_FALSE(map.any(64, 1, BM_DATA));
+
+    std::vector<MemoryMap::Region> code = map.regions(BM_CODE);
+    ASSERT_EQ(1u,code.size());
+    EXPECT_EQ(8u,code[0].start);
+    EXPECT_EQ(16u,code[0].end);
+    std::vector<MemoryMap::Region> gaps = map.regions(BM_UNKNOWN);
+    ASSERT_EQ(3u,gaps.size());
+    EXPECT_EQ(0u,gaps[0].start);
+    EXPECT_EQ(16u,gaps[1].start);
+    EXPECT_EQ(32u,gaps[1].end);
+    EXPECT_EQ(64u,gaps[2].end);
+}
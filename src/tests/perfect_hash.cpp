@@ -0,0 +1,123 @@
+#include "perfhlib.h"
+#include "PatternCollector.h"
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+/* Random tables of the size of a signature file's, with sums of table
+ * entries that overflow 16 bits */
+struct RandomTables {
+    static const int KEYS = 1000, VERT = 2200, LEN = 23;
+    std::vector<uint16_t> t1, t2, g;
+    std::vector<uint8_t> keys;
+    RandomTables() : t1(LEN*256), t2(LEN*256), g(VERT), keys(KEYS*LEN) {
+        std::mt19937 rng(1);
+        for (size_t i = 0; i < t1.size(); ++i) {
+            t1[i] = 60000 + rng() % 5000;
+            t2[i] = rng() % VERT;
+        }
+        for (uint16_t &v : g)
+            v = rng() % KEYS;
+        for (uint8_t &b : keys)
+            b = rng();
+    }
+    /* The hash of key as the two pass loop of the signature tools computes it */
+    int twoPass(const uint8_t *key) const {
+        uint16_t u = 0, v = 0;
+        for (int j = 0; j < LEN; ++j)
+            u += t1[j*256 + key[j]];
+        for (int j = 0; j < LEN; ++j)
+            v += t2[j*256 + key[j]];
+        u %= VERT;
+        v %= VERT;
+        return (g[u] + g[v]) % KEYS;
+    }
+};
+
+TEST(PerfectHash, FusedHashMatchesTwoPassHash) {
+    RandomTables r;
+    PerfectHash hasher;
+    hasher.setHashTables(r.KEYS, r.LEN, 256, 0, r.VERT, r.t1.data(), r.t2.data(), r.g.data());
+    for (int i = 0; i < r.KEYS; ++i)
+        EXPECT_EQ(r.twoPass(&r.keys[i*r.LEN]), hasher.hash(&r.keys[i*r.LEN]));
+}
+
+TEST(PerfectHash, HashManyMatchesHash) {
+    RandomTables r;
+    PerfectHash hasher;
+    hasher.setHashTables(r.KEYS, r.LEN, 256, 0, r.VERT, r.t1.data(), r.t2.data(), r.g.data());
+    /* a count that leaves keys over after the groups */
+    const int count = r.KEYS - 3;
+    std::vector<int> many(count);
+    hasher.hashMany(r.keys.data(), count, many.data());
+    for (int i = 0; i < count; ++i)
+        EXPECT_EQ(r.twoPass(&r.keys[i*r.LEN]), many[i]);
+}
+
+/* Keys of random bytes, no two the same */
+struct RandomKeys : PatternCollector {
+    explicit RandomKeys(int n) {
+        std::mt19937 rng(2);
+        keys.resize(n);
+        for (HASHENTRY &k : keys) {
+            snprintf(k.name, SYMLEN, "key%d", int(&k - &keys[0]));
+            for (uint8_t &b : k.pat)
+                b = rng();
+        }
+    }
+    int readSyms(FILE *) override { return keys.size(); }
+};
+
+TEST(PerfectHash, MappedTablesOnlyDependOnTheSeed) {
+    const int numKeys = 500, numVert = 1100;
+    RandomKeys keys(numKeys);
+    std::vector<uint16_t> t1, t2;
+    int iterations = 0;
+    for (int jobs : {1, 4}) {
+        PerfectHash hasher;
+        hasher.setHashParams(numKeys, PATLEN, 256, 0, numVert);
+        hasher.map(&keys, 7, jobs);
+        hasher.assign();
+        if (jobs == 1) {
+            t1.assign(hasher.readT1(), hasher.readT1() + PATLEN*256);
+            t2.assign(hasher.readT2(), hasher.readT2() + PATLEN*256);
+            iterations = hasher.iterations();
+        } else {
+            EXPECT_TRUE(std::equal(t1.begin(), t1.end(), hasher.readT1()));
+            EXPECT_TRUE(std::equal(t2.begin(), t2.end(), hasher.readT2()));
+            EXPECT_EQ(iterations, hasher.iterations());
+        }
+        /* each key has an entry of its own */
+        std::vector<bool> used(numKeys);
+        for (int i = 0; i < numKeys; ++i) {
+            int h = hasher.hash(keys.getKey(i));
+            ASSERT_TRUE(h >= 0 and h < numKeys);
+            EXPECT_FALSE(used[h]);
+            used[h] = true;
+        }
+        hasher.hashCleanup();
+    }
+}
+
+TEST(PerfectHash, CleanupOnlyFreesAllocatedTables) {
+    RandomTables r;
+    PerfectHash hasher;
+    hasher.setHashTables(r.KEYS, r.LEN, 256, 0, r.VERT, r.t1.data(), r.t2.data(), r.g.data());
+    /* the given tables are read, but not handed out for writing */
+    const PerfectHash &reader(hasher);
+    EXPECT_EQ(r.t1.data(), reader.readT1());
+    EXPECT_EQ(nullptr, hasher.readT1());
+    EXPECT_EQ(nullptr, hasher.readG());
+    hasher.hashCleanup();
+    EXPECT_EQ(nullptr, reader.readT1());
+    EXPECT_EQ(nullptr, reader.readG());
+
+    hasher.setHashParams(r.KEYS, r.LEN, 256, 0, r.VERT);
+    ASSERT_NE(nullptr, hasher.readT1());
+    EXPECT_EQ(hasher.readT1(), reader.readT1());
+    hasher.hashCleanup();
+    EXPECT_EQ(nullptr, hasher.readT1());
+    hasher.hashCleanup();               /* nothing left to free */
+}
@@ -25,3 +25,30 @@ TEST(Project, CreatedProjectHasValidNames) {
         ASSERT_TRUE(p.symtab.empty());
     }
 }
+
+TEST(Project, CreatedFunctionsAreFoundByEntry) {
+    Project p;
+    ilFunction first  = p.createFunction(0,"first",0x100);
+    ilFunction second = p.createFunction(0,"second",0x200);
+    EXPECT_EQ(first,p.findByEntry(0x100));
+    EXPECT_EQ(second,p.findByEntry(0x200));
+    EXPECT_FALSE(p.valid(p.findByEntry(0x300)));
+    EXPECT_EQ(second,p.funcIter(&(*second)));
+    EXPECT_EQ(0x200U,second->procEntry);
+}
+
+TEST(Project, GlobalSymbolsAreFoundByAddress) {
+    Project p;
+    bool created=false;
+    for(uint32_t adr=0; adr<1000; adr++)
+        p.symtab.updateGlobSym(adr*2,2,0,created);
+    EXPECT_EQ(1000U,p.symtab.size());
+    p.symtab.updateGlobSym(0x40,4,0,created);
+    EXPECT_FALSE(created);
+    EXPECT_EQ(1000U,p.symtab.size());
+    int idx = p.getSymIdxByAddr(0x40);
+    ASSERT_TRUE(p.validSymIdx(idx));
+    EXPECT_EQ(0x20,idx);
+    EXPECT_EQ(4U,p.symbolSize(idx));
+    EXPECT_FALSE(p.validSymIdx(p.getSymIdxByAddr(0x41)));
+}
@@ -9,7 +9,10 @@
 #include "project.h"
 
 #include <QtCore/QDebug>
+#include <atomic>
 #include <list>
+#include <thread>
+#include <vector>
 #include <cassert>
 #include <stdio.h>
 #include <CallGraph.h>
@@ -24,6 +27,7 @@ void Function::buildCFG(Disassembler &ds)
 {
     if(flg & PROC_ISLIB)
         return; // Ignore library functions
+    ExprArena::Scope exprScope(m_exprs);
     createCFG();
     if (option.VeryVerbose)
         displayCFG();
@@ -46,6 +50,7 @@ void Function::controlFlowAnalysis()
 {
     if (flg & PROC_ISLIB)
         return;         /* Ignore library functions */
+    ExprArena::Scope exprScope(m_exprs);
     derSeq *derivedG=nullptr;
 
     /* Make cfg reducible and build derived sequences */
@@ -67,10 +72,49 @@ void Function::controlFlowAnalysis()
         //m_cfg.front()->displayDfs();
     }
 
-    /* Free storage occupied by this procedure */
-    freeDerivedSeq(*derivedG);
+    /* Free storage occupied by the derived sequence of graphs */
+    delete derivedG;
+    m_arena.derivedBlocks.release();
 
 }
+/* Runs the procedure local part of buildCFG for all procs on option.Jobs
+ * threads. Interprocedural effects and diagnostics are deferred, and then
+ * applied in the order of procs, so the result matches a sequential run. */
+static void buildCFGParallel(const std::vector<Function *> &procs, Disassembler &ds)
+{
+    std::atomic<size_t> next(0);
+    auto worker = [&procs,&next]()
+    {
+        for (size_t idx = next++; idx < procs.size(); idx = next++)
+        {
+            Function *f = procs[idx];
+            DiagnosticLog::capture(&f->m_deferred->log);
+            ExprArena::Scope exprScope(f->m_exprs);
+            f->createCFG();
+            f->compressCFG();
+            if (not option.asm2)
+            {
+                f->lowLevelAnalysis();
+                f->highLevelGen();
+            }
+            DiagnosticLog::capture(nullptr);
+        }
+    };
+    for (Function *f : procs)
+        f->m_deferred = new DeferredUpdates;
+    std::vector<std::thread> threads;
+    for (int i = 0; i < option.Jobs; ++i)
+        threads.emplace_back(worker);
+    for (std::thread &t : threads)
+        t.join();
+    for (Function *f : procs)
+    {
+        f->applyDeferredUpdates();
+        if (option.asm2)
+            ds.disassem(f); // Print 2nd pass assembler listing
+    }
+}
+
 void udm()
 {
 
@@ -78,6 +122,7 @@ void udm()
      * icodes to high-level ones */
     Project *proj = Project::get();
     Disassembler ds(2);
+    std::vector<Function *> procs;
     for (auto iter = proj->pProcList.rbegin(); iter!=proj->pProcList.rend(); ++iter)
     {
         Function &f(*iter);
@@ -86,8 +131,15 @@ void udm()
                 continue;
             }
         }
-        iter->buildCFG(ds);
+        if (not (f.flg & PROC_ISLIB))
+            procs.push_back(&f);
     }
+    /* Verbose listings are printed between the phases, keep those sequential */
+    if ((option.Jobs > 1) and not option.VeryVerbose)
+        buildCFGParallel(procs, ds);
+    else
+        for (Function *f : procs)
+            f->buildCFG(ds);
     if (option.asm2)
         return;
 
@@ -105,8 +157,7 @@ void udm()
         iter->dataFlow(live_regs);
         iter->controlFlowAnalysis();
         delete proj->callGraph;
-        proj->callGraph = new CALL_GRAPH;
-        proj->callGraph->proc = iter;
+        proj->callGraph = new CALL_GRAPH(iter);
         return;
     }
     proj->pProcList.front().dataFlow (live_regs);
@@ -0,0 +1,116 @@
+/* Microbenchmark of the signature hash: the two pass loop the hash used to
+   be, hash() on T1 and T2 and on the fused table, and hashMany() */
+
+#include "perfhlib.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <chrono>
+#include <random>
+#include <vector>
+
+#define PATLEN  23                      /* Pattern length of the signature files */
+#define C       2.2                     /* Sparseness of graph, as in makedsig */
+
+static std::vector<uint16_t> T1, T2, g;
+
+/* The hash as it was, walking the key once for T1 and once for T2 */
+static int hashTwoPass(const PerfectHash &p_hash, const uint8_t *key)
+{
+    uint16_t u = 0, v = 0;
+    int j;
+
+    for (j=0; j < PATLEN; j++)
+        u += T1[j * 256 + key[j]];
+    u %= p_hash.NumVert;
+    for (j=0; j < PATLEN; j++)
+        v += T2[j * 256 + key[j]];
+    v %= p_hash.NumVert;
+    return (g[u] + g[v]) % p_hash.NumEntry;
+}
+
+/* Runs pass over the keys rounds times, and prints its time per key */
+template<class Pass>
+static long run(const char *name, int numKeys, int rounds, Pass pass)
+{
+    long check = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int r=0; r < rounds; r++)
+        check += pass();
+    double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    printf("%-24s %8.2f ns/key\n", name, ns / ((double)numKeys * rounds));
+    return check;
+}
+
+int main(int argc, char *argv[])
+{
+    int numKeys = (argc > 1) ? atoi(argv[1]) : 100000;  /* Keys hashed per round */
+    int numSigs = (argc > 2) ? atoi(argv[2]) : 1347;    /* Keys of the table, as in the largest .sig */
+    int rounds  = (argc > 3) ? atoi(argv[3]) : 20;
+    int numVert = (int)(numSigs * C);
+    if ((numKeys <= 0) or (numSigs <= 0) or (rounds <= 0))
+    {
+        printf("Usage: hashbench [keys [signatures [rounds]]]\n");
+        return 1;
+    }
+
+    std::mt19937 rng(1);
+    T1.resize(PATLEN * 256);
+    T2.resize(PATLEN * 256);
+    g.resize(numVert);
+    for (int i=0; i < PATLEN * 256; i++)
+    {
+        T1[i] = rng() % numVert;
+        T2[i] = rng() % numVert;
+    }
+    for (uint16_t &v : g)
+        v = rng() % numSigs;
+    std::vector<uint8_t> keys(numKeys * PATLEN);
+    for (uint8_t &b : keys)
+        b = rng();
+    std::vector<int> out(numKeys);
+
+    PerfectHash unfused, fused;
+    unfused.setHashParams(numSigs, PATLEN, 256, 0, numVert);    /* T1 and T2 read directly */
+    std::copy(T1.begin(), T1.end(), unfused.readT1());
+    std::copy(T2.begin(), T2.end(), unfused.readT2());
+    std::copy(g.begin(), g.end(), unfused.readG());
+    fused.setHashTables(numSigs, PATLEN, 256, 0, numVert, T1.data(), T2.data(), g.data());
+
+    printf("%d keys, %d signatures, %d rounds\n", numKeys, numSigs, rounds);
+    long checks[4];
+    checks[0] = run("two pass", numKeys, rounds, [&]() {
+        long sum = 0;
+        for (int i=0; i < numKeys; i++)
+            sum += hashTwoPass(fused, &keys[i * PATLEN]);
+        return sum;
+    });
+    checks[1] = run("hash(), T1 and T2", numKeys, rounds, [&]() {
+        long sum = 0;
+        for (int i=0; i < numKeys; i++)
+            sum += unfused.hash(&keys[i * PATLEN]);
+        return sum;
+    });
+    checks[2] = run("hash(), fused", numKeys, rounds, [&]() {
+        long sum = 0;
+        for (int i=0; i < numKeys; i++)
+            sum += fused.hash(&keys[i * PATLEN]);
+        return sum;
+    });
+    checks[3] = run("hashMany()", numKeys, rounds, [&]() {
+        long sum = 0;
+        fused.hashMany(keys.data(), numKeys, out.data());
+        for (int h : out)
+            sum += h;
+        return sum;
+    });
+    for (long c : checks)
+    {
+        if (c != checks[0])
+        {
+            printf("The hashes differ!\n");
+            return 2;
+        }
+    }
+    return 0;
+}
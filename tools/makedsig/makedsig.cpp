@@ -3,10 +3,13 @@
 #include "LIB_PatternCollector.h"
 #include "TPL_PatternCollector.h"
 #include "perfhlib.h"		/* Symbol table prototypes */
+#include "SigPack.h"
 #include "msvc_fixes.h"
 
 #include <QtCore/QCoreApplication>
 #include <QtCore/QDebug>
+#include <QtCore/QDir>
+#include <QtCore/QFile>
 #include <QtCore/QStringList>
 
 #include <stdio.h>
@@ -14,6 +17,7 @@
 #include <memory.h>
 #include <string.h>
 #include <algorithm>
+#include <chrono>
 
 /* Symbol table constnts */
 #define C 2.2 /* Sparseness of graph. See Czech, Havas and Majewski for details */
@@ -21,6 +25,7 @@
 /* prototypes */
 
 void saveFile(FILE *fl, const PerfectHash &p_hash, PatternCollector *coll);		/* Save the info */
+int makePack(const QString &packName, const QString &sigDir, const QString &protoName);
 
 static int	 numKeys;				/* Number of useful codeview symbols */
 
@@ -33,9 +38,17 @@ static void printUsage(bool longusage) {
                     "of the signature file to be generated.\n"
                     "Example: makedsig CL.LIB dccb3l.sig\n"
                     "      or makedsig turbo.tpl dcct4p.sig\n"
+                    "With -pack, it combines all signature files in a directory and the prototypes file "
+                    "into one signature pack, which dcc reads in place of the single files.\n"
+                    "Example: makedsig -pack dccsigs.pak sigs prototypes/dcclibs.dat\n"
+                    "Options:\n"
+                    "  --seed <n>  seed for the random hash tables; asked for if not given. The same\n"
+                    "              seed gives the same signature file, whatever the number of jobs\n"
+                    "  --jobs <n>  number of threads trying hash tables at once (default 1)\n"
                     );
     else
-        printf("Usage: makedsig <libname> <signame>\n"
+        printf("Usage: makedsig [--seed <n>] [--jobs <n>] <libname> <signame>\n"
+               "or makedsig -pack <packname> <sigdir> <protofile>\n"
                "or makedsig -h for help\n");
 }
 int main(int argc, char *argv[])
@@ -44,16 +57,56 @@ int main(int argc, char *argv[])
     FILE *f2; // output file
     FILE *srcfile; // .lib file
     int s;
-    if(app.arguments().size()<2) {
+    bool haveSeed = false;
+    int jobs = 1;
+    QStringList args; // arguments other than options
+    for (int i = 1; i < app.arguments().size(); i++)
+    {
+        const QString &arg(app.arguments()[i]);
+        if (((arg == "--seed") or (arg == "--jobs")) and (i+1 < app.arguments().size()))
+        {
+            bool ok;
+            int value = app.arguments()[++i].toInt(&ok);
+            if (not ok or ((arg == "--jobs") and (value < 1)))
+            {
+                printf("Bad value for %s\n", qPrintable(arg));
+                return 1;
+            }
+            if (arg == "--seed")
+            {
+                s = value;
+                haveSeed = true;
+            }
+            else
+                jobs = value;
+        }
+        else
+            args << arg;
+    }
+    if(args.size()<1) {
         printUsage(false);
         return 0;
     }
-    QString arg2 = app.arguments()[1];
+    QString arg2 = args[0];
     if (arg2.startsWith("-h") or arg2.startsWith("-?"))
     {
         printUsage(true);
         return 0;
     }
+    if (arg2 == "-pack")
+    {
+        if (args.size() < 4)
+        {
+            printUsage(false);
+            return 0;
+        }
+        return makePack(args[1], args[2], args[3]);
+    }
+    if (args.size() < 2)
+    {
+        printUsage(false);
+        return 0;
+    }
     PatternCollector *collector;
     if(arg2.endsWith("tpl")) {
         collector = new TPL_PatternCollector;
@@ -63,21 +116,27 @@ int main(int argc, char *argv[])
         qCritical() << "Unsupported file type.";
         return -1;
     }
-    if ((srcfile = fopen(argv[1], "rb")) == NULL)
+    if ((srcfile = fopen(qPrintable(args[0]), "rb")) == NULL)
     {
-        printf("Cannot read %s\n", argv[1]);
+        printf("Cannot read %s\n", qPrintable(args[0]));
         exit(2);
     }
 
-    if ((f2 = fopen(argv[2], "wb")) == NULL)
+    if ((f2 = fopen(qPrintable(args[1]), "wb")) == NULL)
     {
-        printf("Cannot write %s\n", argv[2]);
+        printf("Cannot write %s\n", qPrintable(args[1]));
         exit(2);
     }
 
-    fprintf(stderr, "Seed: ");
-    scanf("%d", &s);
-    srand(s);
+    if (not haveSeed)
+    {
+        fprintf(stderr, "Seed: ");
+        if (scanf("%d", &s) != 1)
+        {
+            printf("No seed given\n");
+            exit(2);
+        }
+    }
 
     PerfectHash p_hash;
     numKeys = collector->readSyms(srcfile);			/* Read the keys (symbols) */
@@ -92,7 +151,11 @@ int main(int argc, char *argv[])
                                         Havas and Majewski for details */
 
     /* The following two functions are in perfhlib.c */
-    p_hash.map(collector);     /* Perform the mapping. This will call getKey() repeatedly */
+    auto start = std::chrono::steady_clock::now();
+    p_hash.map(collector, s, jobs);     /* Perform the mapping. This will call getKey() repeatedly */
+    double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    printf("Seed %d: tables found after %d iterations, in %.2f s on %d threads\n",
+           s, p_hash.iterations(), secs, jobs);
     p_hash.assign();						/* Generate the function g */
 
     saveFile(f2,p_hash,collector);     /* Save the resultant information */
@@ -128,6 +191,12 @@ void writeFileShort(FILE *fl,uint16_t w)
     writeFile(fl,(char *)&b, 1);
 }
 
+void writeFileLong(FILE *fl,uint32_t w)
+{
+    writeFileShort(fl,(uint16_t)(w & 0xFFFF));	/* Write a long little endian */
+    writeFileShort(fl,(uint16_t)(w >> 16));
+}
+
 void saveFile(FILE *fl, const PerfectHash &p_hash, PatternCollector *coll)
 {
     int i, len;
@@ -175,5 +244,83 @@ void saveFile(FILE *fl, const PerfectHash &p_hash, PatternCollector *coll)
     }
 }
 
+/*	*	*	*	*	*	*	*	*	*	*	*  *\
+*												*
+*		M a k e   a   s i g n a t u r e   p a c k		*
+*												*
+\*	*	*	*	*	*	*	*	*	*	*	*  */
+
+/* Writes all the signature files in sigDir, and the prototypes file, to the
+    signature pack packName. See SigPack.h for the layout. */
+int makePack(const QString &packName, const QString &sigDir, const QString &protoName)
+{
+    struct Input
+    {
+        QByteArray name;
+        QByteArray contents;
+    };
+    std::vector<Input> inputs;
+    QDir dir(sigDir);
+    QStringList sigNames = dir.entryList(QStringList() << "*.sig", QDir::Files, QDir::Name);
+    for (const QString &sigName : sigNames)
+        inputs.push_back({sigName.left(sigName.lastIndexOf('.')).toLatin1(), QByteArray()});
+    inputs.push_back({QByteArray("dcclibs"), QByteArray()});
 
+    for (size_t i = 0; i < inputs.size(); i++)
+    {
+        QString path = (i < (size_t)sigNames.size()) ? dir.absoluteFilePath(sigNames[i]) : protoName;
+        QFile f(path);
+        if (not f.open(QFile::ReadOnly))
+        {
+            printf("Cannot read %s\n", qPrintable(path));
+            exit(2);
+        }
+        inputs[i].contents = f.readAll();
+        const char *magic = (i < (size_t)sigNames.size()) ? "dccs" : "dccp";
+        if (not inputs[i].contents.startsWith(magic))
+        {
+            printf("%s is not a %s file\n", qPrintable(path), magic);
+            exit(2);
+        }
+        if (inputs[i].name.size() > SigPack::NAME_LEN)
+        {
+            printf("Section name %s is too long for a pack\n", inputs[i].name.constData());
+            exit(2);
+        }
+    }
 
+    FILE *fl = fopen(qPrintable(packName), "wb");
+    if (fl == NULL)
+    {
+        printf("Cannot write %s\n", qPrintable(packName));
+        exit(2);
+    }
+    writeFile(fl,"dccP", 4);					/* Signature */
+    writeFileShort(fl,SigPack::VERSION);
+    writeFileShort(fl,(uint16_t)inputs.size());
+
+    /* The directory, then each section at the next aligned offset */
+    auto align = [](uint32_t off) { return (off + SigPack::ALIGN - 1) & ~(uint32_t)(SigPack::ALIGN - 1); };
+    uint32_t offset = align(SigPack::HEADER_SIZE + inputs.size() * SigPack::ENTRY_SIZE);
+    for (const Input &in : inputs)
+    {
+        char name[SigPack::NAME_LEN] = {0};
+        memcpy(name, in.name.constData(), in.name.size());
+        writeFile(fl,name, SigPack::NAME_LEN);
+        writeFileLong(fl,offset);
+        writeFileLong(fl,in.contents.size());
+        offset = align(offset + in.contents.size());
+    }
+    uint32_t pos = SigPack::HEADER_SIZE + inputs.size() * SigPack::ENTRY_SIZE;
+    for (const Input &in : inputs)
+    {
+        static const char pad[SigPack::ALIGN] = {0};
+        writeFile(fl,pad, align(pos) - pos);
+        writeFile(fl,in.contents.constData(), in.contents.size());
+        pos = align(pos) + in.contents.size();
+        printf("%-8s %6d bytes\n", in.name.constData(), in.contents.size());
+    }
+    fclose(fl);
+    printf("Wrote %d sections to %s\n", (int)inputs.size(), qPrintable(packName));
+    return 0;
+}
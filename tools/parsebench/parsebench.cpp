@@ -0,0 +1,140 @@
+/* Benchmark of the icode label lookups of the parser, on dcc's own CIcodeRec.
+   The program given goes through dcc's front end (FollowCtrl and
+   bindIcodeOff), which is timed. The lookups and additions the parse made on
+   the icode list of each procedure are then replayed on fresh CIcodeRecs, once
+   with CIcodeRec::labelSrch and its label index, and once with the linear
+   search over the entries labelSrch used to make. Run from the dcc directory,
+   so that the signatures are found. */
+
+#include "dcc.h"
+#include "project.h"
+#include "DccFrontend.h"
+#include "icode.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
+#define NO_TARGET   0xFFFFFFFF  /* Target of a jump bindIcodeOff did not find */
+
+/* The icodes of a procedure, and the targets of its direct jumps */
+struct ProcTrace
+{
+    std::vector<ICODE>      icodes;
+    std::vector<uint32_t>   jumps;
+};
+
+/* labelSrch as it was before the label index */
+static CIcodeRec::iterator linearSrch(CIcodeRec &rec, uint32_t target)
+{
+    return std::find_if(rec.entries.begin(), rec.entries.end(),
+                        [target](ICODE &ic) { return ic.ll()->label == target; });
+}
+
+/* Parses each instruction as FollowCtrl does: a lookup of its label, then
+   addIcode. Then looks up the jump targets as bindIcodeOff does. Returns the
+   number of lookups that hit. */
+template<bool indexed>
+static long replay(const std::vector<ProcTrace> &traces)
+{
+    long hits = 0;
+    for (const ProcTrace &t : traces)
+    {
+        CIcodeRec rec;
+        for (const ICODE &ic : t.icodes)
+        {
+            ICODE copy(ic);
+            auto loc = indexed ? rec.labelSrch(ic.ll()->label) : linearSrch(rec, ic.ll()->label);
+            hits += (loc != rec.entries.end());
+            rec.addIcode(&copy);
+        }
+        for (uint32_t target : t.jumps)
+        {
+            auto loc = indexed ? rec.labelSrch(target) : linearSrch(rec, target);
+            hits += (loc != rec.entries.end());
+        }
+    }
+    return hits;
+}
+
+/* Runs pass rounds times, and returns its time per round in microseconds */
+template<class Pass>
+static double run(int rounds, long &check, Pass pass)
+{
+    auto start = std::chrono::steady_clock::now();
+    for (int r=0; r < rounds; r++)
+        check = pass();
+    return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() / rounds;
+}
+
+int main(int argc, char *argv[])
+{
+    int rounds = 20;
+    int first = 1;
+    if ((argc > 2) and (argv[1][0] == '-') and (argv[1][1] == 'r'))
+    {
+        rounds = atoi(argv[2]);
+        first = 3;
+    }
+    /* The project is a single instance, so one program per run */
+    if ((first != argc - 1) or (rounds <= 0))
+    {
+        printf("Usage: parsebench [-r rounds] program\n");
+        return 1;
+    }
+
+    Project *proj = Project::get();
+    option.Jobs = 1;
+    proj->create(argv[first]);
+    if (not proj->load())
+    {
+        printf("Cannot load %s\n", argv[first]);
+        return 1;
+    }
+    DccFrontend fe(nullptr);
+    auto start = std::chrono::steady_clock::now();
+    fe.FrontEnd();
+    double frontEnd = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+
+    std::vector<ProcTrace> traces;
+    long icodes = 0, lookups = 0;
+    for (Function &f : proj->pProcList)
+    {
+        traces.emplace_back();
+        ProcTrace &t(traces.back());
+        for (ICODE &ic : f.Icode.entries)
+        {
+            t.icodes.push_back(ic);
+            LLInst *ll = ic.ll();
+            if (not ll->isJmpInst() or not ll->testFlags(I))
+                continue;
+            /* bindIcodeOff has replaced the target with the index of its icode */
+            if (ll->testFlags(NO_LABEL))
+                t.jumps.push_back(NO_TARGET);
+            else
+                t.jumps.push_back(f.Icode.entries[ll->src().getImm2()].ll()->label);
+        }
+        icodes += t.icodes.size();
+        lookups += t.icodes.size() + t.jumps.size();
+    }
+
+    long linearHits = 0, indexedHits = 0;
+    double linear = run(rounds, linearHits, [&]() { return replay<false>(traces); });
+    double indexed = run(rounds, indexedHits, [&]() { return replay<true>(traces); });
+    if (linearHits != indexedHits)
+    {
+        printf("The lookups differ!\n");
+        return 2;
+    }
+    const char *base = argv[first];
+    for (const char *p = argv[first]; *p; p++)
+        if ((*p == '/') or (*p == '\\'))
+            base = p + 1;
+    printf("%-14s %6s %8s %8s %12s %12s %12s\n", "program", "procs", "icodes", "lookups",
+           "frontend us", "linear us", "indexed us");
+    printf("%-14s %6zu %8ld %8ld %12.1f %12.1f %12.1f\n", base, traces.size(), icodes, lookups,
+           frontEnd, linear, indexed);
+    return 0;
+}
@@ -0,0 +1,93 @@
+/* Scaling benchmark of the global symbol lookups of lookupAddr: the linear
+   searches of the symbol table and of the relocation table it used to make,
+   and the label index of SymbolTableCommon with PROG::isRelocated */
+
+#include "symtab.h"
+#include "BinaryImage.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <chrono>
+#include <vector>
+
+#define REFS    8               /* References of each global */
+
+/* Runs a lookupAddr shaped workload: numGlobals globals, each referenced REFS
+   times, with a relocation check when a symbol is created. Returns the time
+   in milliseconds, and a sum of the results in check. */
+static double run(size_t numGlobals, bool indexed, uint64_t &check)
+{
+    SymbolTableCommon<SYM> symtab;
+    if (indexed)
+        symtab.enableLabelIndex();
+    PROG prog;
+    for (size_t i=0; i < numGlobals / 4; i++)
+        prog.relocTable.push_back(uint32_t(i * 7 + 1));
+    prog.indexRelocations();
+
+    check = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int r=0; r < REFS; r++)
+    {
+        for (size_t i=0; i < numGlobals; i++)
+        {
+            uint32_t label = uint32_t((i * 2654435761u) % (numGlobals * 16));
+            auto iter = symtab.findByLabel(label);
+            if (iter != symtab.end())
+            {
+                check += iter->label;
+                continue;
+            }
+            SYM sym;
+            sym.label = label;
+            symtab.push_back(sym);
+            bool relocated = false;
+            if (indexed)
+                relocated = prog.isRelocated(label + 2);
+            else
+            {
+                for (uint32_t reloc : prog.relocTable)
+                {
+                    if (reloc == label + 2)
+                    {
+                        relocated = true;
+                        break;
+                    }
+                }
+            }
+            check += relocated;
+        }
+    }
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char *argv[])
+{
+    std::vector<size_t> sizes;
+    for (int i=1; i < argc; i++)
+        sizes.push_back(strtoul(argv[i], nullptr, 10));
+    if (sizes.empty())
+        sizes = {1000, 10000, 100000};
+    for (size_t n : sizes)
+    {
+        if (n == 0)
+        {
+            printf("Usage: symbench [globals...]\n");
+            return 1;
+        }
+    }
+
+    for (size_t n : sizes)
+    {
+        uint64_t linearCheck, indexedCheck;
+        double linear = run(n, false, linearCheck);
+        double indexed = run(n, true, indexedCheck);
+        printf("N=%-8zu linear %12.2f ms    indexed %10.2f ms\n", n, linear, indexed);
+        if (linearCheck != indexedCheck)
+        {
+            printf("The lookups differ!\n");
+            return 2;
+        }
+    }
+    return 0;
+}